@@ -0,0 +1,231 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * benchmark file, measures the cost of some operations of RuntimeBitset
+ */
+
+// Compilation: g++ -std=c++20 -O2 -Wall -Werror -pedantic bench/bench.cpp -Ilib -o runtimebitset_bench
+
+#include "RuntimeBitset/RuntimeBitset.hpp"
+#include "RuntimeBitset/HammingIndex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace RunBitset;
+
+namespace {
+
+constexpr std::size_t BITSET_SIZE = 100'000'000;
+constexpr std::size_t NUM_OPERATIONS = 10'000'000;
+
+// Returns the time in nanoseconds per operation of t_function, called t_operations times
+template <typename Function>
+double measure(const std::size_t t_operations, Function t_function) {
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < t_operations; ++i) {
+    t_function(i);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double, std::nano> elapsed = end - start;
+  return elapsed.count() / static_cast<double>(t_operations);
+}
+
+void printResult(const std::string& t_name, const double t_nanoseconds) {
+  std::cout << t_name << ": " << t_nanoseconds << " ns/op" << std::endl;
+}
+
+// Single bit modifiers and count(), with and without the cached count
+void benchCountCache() {
+  std::mt19937_64 generator(42);
+  std::vector<std::size_t> positions(NUM_OPERATIONS);
+  for (std::size_t& position : positions) {
+    position = generator() % BITSET_SIZE;
+  }
+  std::size_t sink = 0; // avoid the compiler removing the loops
+
+  for (const bool cached : {false, true}) {
+    RuntimeBitset bitset(BITSET_SIZE);
+    if (cached) bitset.enableCountCache();
+    const std::string mode = cached ? " (cached count)" : " (no cache)";
+
+    printResult("set(pos)" + mode, measure(NUM_OPERATIONS, [&](std::size_t i) {
+      bitset.set(positions[i]);
+    }));
+    printResult("reset(pos)" + mode, measure(NUM_OPERATIONS, [&](std::size_t i) {
+      bitset.reset(positions[i]);
+    }));
+    printResult("flip(pos)" + mode, measure(NUM_OPERATIONS, [&](std::size_t i) {
+      bitset.flip(positions[i]);
+    }));
+    // count after every few modifications, as an admission controller would do
+    printResult("4 x set(pos) + count()" + mode, measure(NUM_OPERATIONS / 1000, [&](std::size_t i) {
+      for (std::size_t j = 0; j < 4; ++j) bitset.set(positions[i * 4 + j]);
+      sink += bitset.count();
+    }));
+  }
+  std::cout << "(" << sink << ")" << std::endl;
+}
+
+// Construction of big bitsets, the blocks are not touched until they are used
+void benchConstruction() {
+  // volatile, with a constant size the compiler folds the work of the construction away
+  volatile std::size_t scratchSize = 8ull * 1024 * 1024 * 1024; // 1 GB of blocks
+  std::size_t sink = 0;
+  printResult("RuntimeBitset(1 GB)", measure(10, [&](std::size_t) {
+    RuntimeBitset bitset(scratchSize);
+    sink += bitset.size();
+  }));
+  printResult("RuntimeBitset(1 GB, uninitialized)", measure(10, [&](std::size_t) {
+    RuntimeBitset bitset(scratchSize, uninitialized);
+    sink += bitset.size();
+  }));
+  std::cout << "(" << sink << ")" << std::endl;
+}
+
+// Random test(pos)/set(pos) in a big bitset, with and without huge pages
+void benchHugePages() {
+  constexpr std::size_t BIG_SIZE = 4ull * 1024 * 1024 * 1024; // 512 MB of blocks
+  std::mt19937_64 generator(7);
+  std::vector<std::size_t> positions(NUM_OPERATIONS);
+  for (std::size_t& position : positions) {
+    position = generator() % BIG_SIZE;
+  }
+  std::size_t sink = 0;
+  const std::size_t defaultThreshold = RuntimeBitset::getHugePageThreshold();
+
+  for (const bool huge : {false, true}) {
+    RuntimeBitset::setHugePageThreshold(huge ? defaultThreshold : static_cast<std::size_t>(-1));
+    RuntimeBitset bitset(BIG_SIZE);
+    bitset.set(); // fault in all the pages before measuring
+    bitset.reset();
+    const std::string mode = bitset.usesHugePages() ? " (huge pages)" : " (4 KB pages)";
+
+    printResult("random set(pos)" + mode, measure(NUM_OPERATIONS, [&](std::size_t i) {
+      bitset.set(positions[i]);
+    }));
+    printResult("random test(pos)" + mode, measure(NUM_OPERATIONS, [&](std::size_t i) {
+      sink += bitset.test(positions[NUM_OPERATIONS - 1 - i]);
+    }));
+  }
+  RuntimeBitset::setHugePageThreshold(defaultThreshold);
+  std::cout << "(" << sink << ")" << std::endl;
+}
+
+// Bulk kernels in bitsets much bigger than the cache, with and without streaming stores
+void benchStreaming() {
+  constexpr std::size_t BIG_SIZE = 2ull * 1024 * 1024 * 1024; // 256 MB of blocks
+  constexpr double BIG_BYTES = BIG_SIZE / 8.0;
+  const std::size_t defaultThreshold = RuntimeBitset::getStreamingThreshold();
+  RuntimeBitset source1(BIG_SIZE);
+  source1.set();
+  std::size_t sink = 0;
+
+  for (const bool streaming : {false, true}) {
+    RuntimeBitset::setStreamingThreshold(streaming ? defaultThreshold : static_cast<std::size_t>(-1));
+    const std::string mode = streaming ? " (streaming stores)" : " (normal stores)";
+    RuntimeBitset destination(BIG_SIZE);
+    auto printBandwidth = [&mode](const std::string& t_name, const double t_nanoseconds) {
+      std::cout << t_name << mode << ": " << BIG_BYTES / t_nanoseconds << " GB/s written" << std::endl;
+    };
+    destination.set(); // fault in all the pages before measuring
+    printBandwidth("set()", measure(5, [&](std::size_t) {destination.set();}));
+    printBandwidth("reset()", measure(5, [&](std::size_t) {destination.reset();}));
+    sink += destination.count();
+  }
+  RuntimeBitset::setStreamingThreshold(defaultThreshold);
+  // In place, so it doesn´t measure the allocation of the result (a & b would)
+  // Always normal stores, the blocks were just read (streaming them was slower)
+  RuntimeBitset destination(BIG_SIZE);
+  destination.set();
+  std::cout << "a &= b: " << BIG_BYTES / measure(5, [&](std::size_t) {destination &= source1;}) 
+    << " GB/s written" << std::endl;
+  sink += destination.count();
+  std::cout << "(" << sink << ")" << std::endl;
+}
+
+// Text formats of a big bitset, the hex ones use SSSE3 if it is enabled (-mssse3 or -march=native)
+void benchTextFormats() {
+  RuntimeBitset bitset(BITSET_SIZE);
+  std::mt19937_64 generator(42);
+  for (std::size_t i = 0; i < BITSET_SIZE / 64; ++i) {
+    if (generator() % 2 == 0) bitset.set(generator() % BITSET_SIZE);
+  }
+  const std::string hex = bitset.to_hex();
+  const std::string base64 = bitset.to_base64();
+  std::size_t sink = 0;
+  auto printSpeed = [](const std::string& t_name, const std::size_t t_chars, const double t_nanoseconds) {
+    std::cout << t_name << ": " << static_cast<double>(t_chars) / t_nanoseconds << " GB/s of text" << std::endl;
+  };
+#if defined(RUNBITSET_SSSE3_HEX)
+  std::cout << "(hex with SSSE3)" << std::endl;
+#endif
+  printSpeed("to_hex()", hex.size(), measure(5, [&](std::size_t) {sink += bitset.to_hex().size();}));
+  printSpeed("from_hex()", hex.size(), measure(5, [&](std::size_t) {
+    sink += RuntimeBitset::from_hex(hex, BITSET_SIZE).size();
+  }));
+  printSpeed("to_base64()", base64.size(), measure(5, [&](std::size_t) {sink += bitset.to_base64().size();}));
+  printSpeed("from_base64()", base64.size(), measure(5, [&](std::size_t) {
+    sink += RuntimeBitset::from_base64(base64, BITSET_SIZE).size();
+  }));
+  std::cout << "(" << sink << ")" << std::endl;
+}
+
+// Queries per second of knn() in a big pool, scanning all of it and with the multi index
+// The bitsets are near copies of some centers (like the descriptors of similar images)
+void benchHammingIndex() {
+  constexpr std::size_t POOL_SIZE = 1'000'000;
+  constexpr std::size_t CENTERS = 1000;
+  constexpr std::size_t QUERIES = 20;
+  constexpr std::size_t K = 10;
+  std::mt19937_64 generator(42);
+  std::size_t sink = 0;
+#if defined(RUNBITSET_AVX512_POPCOUNT)
+  std::cout << "(distance with AVX-512)" << std::endl;
+#endif
+  std::cout << "(" << std::max(std::thread::hardware_concurrency(), 1u) << " hardware threads)" << std::endl;
+  for (const std::size_t width : {64, 256, 1024}) {
+    std::vector<RuntimeBitset> centers(CENTERS, RuntimeBitset(width));
+    for (RuntimeBitset& center : centers) {
+      for (std::size_t block = 0; block < center.blocks(); ++block) center.setBlock(block, generator());
+    }
+    auto nearCopy = [&]() {
+      RuntimeBitset copy = centers[generator() % CENTERS];
+      for (std::size_t flips = generator() % 5; flips > 0; --flips) copy.flip(generator() % width);
+      return copy;
+    };
+    BitsetPool pool(width, POOL_SIZE);
+    for (std::size_t i = 0; i < POOL_SIZE; ++i) pool[i].assign(nearCopy());
+    std::vector<RuntimeBitset> queries;
+    for (std::size_t i = 0; i < QUERIES; ++i) queries.push_back(nearCopy());
+    // One thread, and one per hardware thread (by default)
+    HammingIndex single(pool, 1);
+    HammingIndex threaded(pool);
+    auto printQueries = [width](const std::string& t_name, const double t_nanoseconds) {
+      std::cout << t_name << " (" << width << " bits): " << 1e9 / t_nanoseconds << " queries/s" << std::endl;
+    };
+    printQueries("knn() scan, 1 thread", measure(QUERIES, [&](std::size_t i) {sink += single.knn(queries[i], K).size();}));
+    printQueries("knn() scan, all threads", measure(QUERIES, [&](std::size_t i) {sink += threaded.knn(queries[i], K).size();}));
+    single.buildMultiIndex(width / 16);
+    threaded.buildMultiIndex(width / 16);
+    printQueries("knn() multi index, 1 thread", measure(QUERIES, [&](std::size_t i) {sink += single.knn(queries[i], K).size();}));
+    printQueries("knn() multi index, all threads", measure(QUERIES, [&](std::size_t i) {sink += threaded.knn(queries[i], K).size();}));
+  }
+  std::cout << "(" << sink << ")" << std::endl;
+}
+
+} // namespace
+
+int main() {
+  benchCountCache();
+  benchConstruction();
+  benchHugePages();
+  benchStreaming();
+  benchTextFormats();
+  benchHammingIndex();
+  return 0;
+}
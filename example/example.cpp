@@ -48,7 +48,7 @@ int main() {
   bitset4.flip(20); // flip the value in position 20 (starting from the less significant)
   std::cout << bitset4 << std::endl;
 
-  ~bitset4; // Same as flip()
+  bitset4 = ~bitset4; // Same as flip(), ~bitset4 alone doesn´t modify the bitset
   std::cout << bitset4 << std::endl;
 
   std::cout << bitset4.all() << std::endl; // returns true if all bits are set to 1
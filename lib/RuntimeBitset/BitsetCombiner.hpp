@@ -0,0 +1,223 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, interface of the class BitsetCombiner, combines bitset files
+ *   chunk by chunk, without loading them in memory
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+#include "RuntimeBitsetIO.hpp"
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <future>
+#include <bit>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+namespace RunBitset {
+
+// Reads several files of BitsetFile (with the same size) by chunks of the same blocks,
+//   applies an expression to each chunk and writes the result to another file, or counts it
+// The next chunk of all the inputs is read (and the last result is written) while the current one is computed,
+//   so the memory used is about 2 * (inputs + 1) * chunk blocks, whatever the size of the files
+// The checksum of every input is checked at the end, RuntimeBitsetInvalidFile if one doesn´t match
+// combineTo writes to t_path + ".tmp" and renames it at the end, so t_path is never left half written
+class BitsetCombiner {
+  public:
+    inline static constexpr std::size_t DEFAULT_CHUNK_BLOCKS = 128 * 1024; // 1 MB
+
+    // AND_NOT is the first input without the bits of the rest
+    enum Operation {AND, OR, XOR, AND_NOT};
+
+    // The headers are read here, RuntimeBitsetSizeDismatch if the sizes are not the same
+    inline explicit BitsetCombiner(const std::vector<std::string>& t_paths, const std::size_t t_chunkBlocks = DEFAULT_CHUNK_BLOCKS);
+    BitsetCombiner(const BitsetCombiner&) = delete;
+    BitsetCombiner& operator=(const BitsetCombiner&) = delete;
+
+    inline std::size_t size() const noexcept {return m_size;}
+    inline std::size_t inputs() const noexcept {return m_files.size();}
+
+    // The expression is called for each chunk as t_expression(t_inputs, t_result, t_count),
+    //   t_inputs[i] are the t_count blocks of the input i, and the t_count blocks of t_result must be written
+    // The no significant bits of the result are set to 0 after it
+    // RuntimeBitsetFileError if t_path is one of the inputs
+    template<typename Expression>
+    inline void combineTo(const std::string& t_path, Expression t_expression);
+    template<typename Expression>
+    inline std::size_t count(Expression t_expression);
+
+    inline void combineTo(const std::string& t_path, const Operation t_operation);
+    inline std::size_t count(const Operation t_operation);
+
+  private:
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    inline static constexpr std::size_t ALL_BITS_ONE = ~static_cast<std::size_t>(0);
+
+    // PRIVATE METHODS
+    // Reads all the chunks and calls t_consumer(t_result, t_first, t_count) with the result of each one
+    template<typename Expression, typename Consumer>
+    inline void stream(Expression& t_expression, Consumer t_consumer);
+    // Calls t_function with the expression of t_operation
+    template<typename Function>
+    inline static decltype(auto) withOperation(const Operation t_operation, Function t_function);
+
+    // Attributes
+    std::vector<std::unique_ptr<PositionalFile>> m_files; // PositionalFile can´t be moved
+    std::vector<std::string> m_paths;
+    std::size_t m_size = 0;
+    std::size_t m_blocks = 0;
+    std::size_t m_chunkBlocks = 0;
+};
+
+} // namespace RunBitset
+
+
+RunBitset::BitsetCombiner::BitsetCombiner(const std::vector<std::string>& t_paths, const std::size_t t_chunkBlocks)
+: m_chunkBlocks(std::max<std::size_t>(t_chunkBlocks, 1)) {
+  if (t_paths.empty()) throw (RunBitsetException::RuntimeBitsetInvalidSize());
+  for (const std::string& path : t_paths) {
+    m_paths.push_back(path);
+    m_files.push_back(std::make_unique<PositionalFile>(path, PositionalFile::READ));
+    const std::size_t size = BitsetFile::readHeader(*m_files.back());
+    if (m_size != 0 && size != m_size) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+    m_size = size;
+  }
+  m_blocks = (m_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+}
+
+// The first input is copied, and the rest are applied to it input by input (better for the cache than block by block)
+template<typename Function>
+decltype(auto) RunBitset::BitsetCombiner::withOperation(const Operation t_operation, Function t_function) {
+  auto expression = [](auto t_apply) {
+    return [t_apply](const std::vector<const std::size_t*>& t_inputs, std::size_t* t_result, const std::size_t t_count) {
+      std::copy_n(t_inputs[0], t_count, t_result);
+      for (std::size_t i = 1; i < t_inputs.size(); ++i) {
+        for (std::size_t j = 0; j < t_count; ++j) {
+          t_result[j] = t_apply(t_result[j], t_inputs[i][j]);
+        }
+      }
+    };
+  };
+  switch (t_operation) {
+    case AND:
+      return t_function(expression([](const std::size_t t_1, const std::size_t t_2) {return t_1 & t_2;}));
+    case OR:
+      return t_function(expression([](const std::size_t t_1, const std::size_t t_2) {return t_1 | t_2;}));
+    case XOR:
+      return t_function(expression([](const std::size_t t_1, const std::size_t t_2) {return t_1 ^ t_2;}));
+    default: // AND_NOT
+      return t_function(expression([](const std::size_t t_1, const std::size_t t_2) {return t_1 & ~t_2;}));
+  }
+}
+
+template<typename Expression>
+void RunBitset::BitsetCombiner::combineTo(const std::string& t_path, Expression t_expression) {
+  // The inputs are still being read while the result is written
+  for (const std::string& path : m_paths) {
+    std::error_code error;
+    if (std::filesystem::equivalent(path, t_path, error)) throw(RunBitsetException::RuntimeBitsetFileError());
+  }
+  const std::string temporaryPath = t_path + ".tmp";
+  try {
+    PositionalFile file(temporaryPath, PositionalFile::CREATE);
+    const std::uint64_t header[BitsetFile::HEADER_WORDS] = {BitsetFile::toLittleEndian(BitsetFile::MAGIC),
+      BitsetFile::toLittleEndian(m_size), BitsetFile::toLittleEndian(m_blocks)};
+    file.writeAt(0, header, sizeof(header));
+    std::vector<std::size_t> buffers[2];
+    std::future<void> pending;
+    std::uint64_t hash = BitsetFile::HASH_OFFSET;
+    // Same as BitsetFile::save, the chunk i is written while the chunk i + 1 is computed
+    stream(t_expression, [&](const std::size_t* t_result, const std::size_t t_first, const std::size_t t_count) {
+      std::vector<std::size_t>& buffer = buffers[(t_first / m_chunkBlocks) % 2];
+      buffer.assign(t_result, t_result + t_count);
+      hash = BitsetFile::checksum(hash, buffer.data(), t_count);
+      for (std::size_t& block : buffer) block = BitsetFile::toLittleEndian(block);
+      if (pending.valid()) pending.get(); // the other buffer is free again
+      pending = std::async(std::launch::async, [&file, &buffer, t_first, t_count]() {
+        file.writeAt(BitsetFile::blocksOffset(t_first), buffer.data(), t_count * sizeof(std::size_t));
+      });
+    });
+    if (pending.valid()) pending.get();
+    const std::uint64_t trailer = BitsetFile::toLittleEndian(hash);
+    file.writeAt(BitsetFile::blocksOffset(m_blocks), &trailer, sizeof(trailer));
+  }
+  catch (...) { // a wrong checksum of an input is only known at the end
+    std::error_code error;
+    std::filesystem::remove(temporaryPath, error);
+    throw;
+  }
+  std::filesystem::rename(temporaryPath, t_path);
+}
+
+template<typename Expression>
+std::size_t RunBitset::BitsetCombiner::count(Expression t_expression) {
+  std::size_t numberOfActive = 0;
+  stream(t_expression, [&](const std::size_t* t_result, const std::size_t, const std::size_t t_count) {
+    for (std::size_t i = 0; i < t_count; ++i) {
+      numberOfActive += std::popcount(t_result[i]);
+    }
+  });
+  return numberOfActive;
+}
+
+void RunBitset::BitsetCombiner::combineTo(const std::string& t_path, const Operation t_operation) {
+  withOperation(t_operation, [&](auto t_expression) {combineTo(t_path, t_expression);});
+}
+
+std::size_t RunBitset::BitsetCombiner::count(const Operation t_operation) {
+  return withOperation(t_operation, [&](auto t_expression) {return count(t_expression);});
+}
+
+// The chunk i + 1 of all the inputs is read (in another thread) while the chunk i is computed
+template<typename Expression, typename Consumer>
+void RunBitset::BitsetCombiner::stream(Expression& t_expression, Consumer t_consumer) {
+  const std::size_t numberOfInputs = m_files.size();
+  const std::size_t lastMask = ALL_BITS_ONE >> (m_blocks * BLOCK_SIZE - m_size);
+  std::vector<std::size_t> buffers[2];
+  buffers[0].resize(numberOfInputs * std::min(m_chunkBlocks, m_blocks));
+  buffers[1].resize(buffers[0].size());
+  std::vector<std::size_t> result(std::min(m_chunkBlocks, m_blocks));
+  std::vector<const std::size_t*> chunks(numberOfInputs);
+  std::vector<std::uint64_t> hashes(numberOfInputs, BitsetFile::HASH_OFFSET);
+  auto read = [&](const std::size_t t_first) {
+    const std::size_t count = std::min(m_chunkBlocks, m_blocks - t_first);
+    std::size_t* buffer = buffers[(t_first / m_chunkBlocks) % 2].data();
+    return std::async(std::launch::async, [this, buffer, t_first, count, numberOfInputs]() {
+      for (std::size_t i = 0; i < numberOfInputs; ++i) {
+        m_files[i]->readAt(BitsetFile::blocksOffset(t_first), buffer + i * count, count * sizeof(std::size_t));
+      }
+    });
+  };
+  std::future<void> pending = read(0);
+  for (std::size_t first = 0; first < m_blocks; first += m_chunkBlocks) {
+    pending.get();
+    const std::size_t count = std::min(m_chunkBlocks, m_blocks - first);
+    if (first + count < m_blocks) pending = read(first + count);
+    std::size_t* buffer = buffers[(first / m_chunkBlocks) % 2].data();
+    for (std::size_t i = 0; i < numberOfInputs; ++i) {
+      std::size_t* chunk = buffer + i * count;
+      for (std::size_t j = 0; j < count; ++j) {
+        chunk[j] = BitsetFile::toLittleEndian(chunk[j]);
+      }
+      hashes[i] = BitsetFile::checksum(hashes[i], chunk, count);
+      chunks[i] = chunk;
+    }
+    t_expression(chunks, result.data(), count);
+    if (first + count == m_blocks) result[count - 1] &= lastMask;
+    t_consumer(result.data(), first, count);
+  }
+  for (std::size_t i = 0; i < numberOfInputs; ++i) {
+    std::uint64_t trailer = 0;
+    m_files[i]->readAt(BitsetFile::blocksOffset(m_blocks), &trailer, sizeof(trailer));
+    if (BitsetFile::toLittleEndian(trailer) != hashes[i]) throw(RunBitsetException::RuntimeBitsetInvalidFile());
+  }
+}
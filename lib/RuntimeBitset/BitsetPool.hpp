@@ -0,0 +1,560 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, interface of the classes BitsetPool and BitsetView, represents
+ *   many bitsets of the same size stored one after another in the same memory
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+
+#include <string>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <new>
+#include <bit>
+#include <type_traits>
+#include <algorithm>
+
+namespace RunBitset {
+
+// Handle of a bitset of a BitsetPool (or of any array of blocks), it doesn´t own the blocks
+// BitsetView can modify them, ConstBitsetView only reads them
+// The no significant bits of the last block must be 0, and the modifiers keep them so
+template<typename Block>
+class BasicBitsetView {
+  public:
+    inline BasicBitsetView(Block* t_blocks, const std::size_t t_size) noexcept
+    : m_blocks(t_blocks), m_size(t_size) {}
+    // A BitsetView can be used as a ConstBitsetView
+    inline operator BasicBitsetView<const std::size_t>() const noexcept {return {m_blocks, m_size};}
+
+    inline std::string to_string() const;
+    inline RuntimeBitset toRuntimeBitset() const;
+
+    // NORMAL MEMBERS
+    inline bool operator[](std::size_t t_position) const;
+    inline bool test(std::size_t t_position) const;
+
+    inline bool all() const noexcept;
+    inline bool any() const noexcept;
+    inline bool none() const noexcept;
+
+    inline std::size_t count() const noexcept;
+
+    // Find the first active bit starting in t_position, returns size() if there isn´t any
+    inline std::size_t find_first() const noexcept;
+    inline std::size_t find_next(const std::size_t t_position) const noexcept;
+
+    // Capacity
+    inline std::size_t size() const noexcept {return m_size;}
+    inline std::size_t blocks() const noexcept {return (m_size + BLOCK_SIZE - 1) / BLOCK_SIZE;}
+    inline Block* data() const noexcept {return m_blocks;}
+
+    inline std::size_t getBlock(const std::size_t t_block) const;
+
+    // Modifiers, only BitsetView
+    inline BasicBitsetView& setBlock(const std::size_t t_block, const std::size_t t_value) requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& set() requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& set(const std::size_t t_position) requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& reset() requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& reset(const std::size_t t_position) requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& flip() requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& flip(const std::size_t t_position) requires (!std::is_const_v<Block>);
+    // Copy the bits of t_bitset (same size)
+    inline BasicBitsetView& assign(const RuntimeBitset& t_bitset) requires (!std::is_const_v<Block>);
+
+    inline BasicBitsetView& operator&=(const RuntimeBitset& t_other) requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& operator|=(const RuntimeBitset& t_other) requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& operator^=(const RuntimeBitset& t_other) requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& operator&=(const BasicBitsetView<const std::size_t>& t_other) requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& operator|=(const BasicBitsetView<const std::size_t>& t_other) requires (!std::is_const_v<Block>);
+    inline BasicBitsetView& operator^=(const BasicBitsetView<const std::size_t>& t_other) requires (!std::is_const_v<Block>);
+
+  private:
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    inline static constexpr std::size_t ALL_BITS_ONE = ~static_cast<std::size_t>(0);
+
+    // PRIVATE METHODS
+    inline std::size_t getMask(const std::size_t t_block) const noexcept;
+    inline void checkPosition(const std::size_t t_position) const;
+    inline void checkSize(const std::size_t t_size) const;
+    template<typename Operation>
+    inline void apply(const RuntimeBitset& t_other, Operation t_operation);
+    template<typename Operation>
+    inline void apply(const BasicBitsetView<const std::size_t>& t_other, Operation t_operation);
+
+    // Attributes
+    Block* m_blocks;
+    std::size_t m_size;
+};
+
+using BitsetView = BasicBitsetView<std::size_t>;
+using ConstBitsetView = BasicBitsetView<const std::size_t>;
+
+// N bitsets of width() bits, one after another (blocks() blocks each) in one array aligned to a cache line
+// Compared with N RuntimeBitset, there is no header or allocation per bitset, and the batch members
+//   (count_all(), and_with_all()...) go through the memory in order
+class BitsetPool {
+  public:
+    inline static constexpr std::size_t ALIGNMENT = 64;
+
+    // SPECIAL MEMBERS
+    // t_count bitsets of t_width bits, all 0
+    inline explicit BitsetPool(const std::size_t t_width, const std::size_t t_count = 0);
+    inline ~BitsetPool(); // Destructor
+    inline BitsetPool(const BitsetPool& t_BitsetPool); // Copy constructor
+    inline BitsetPool& operator=(const BitsetPool& t_BitsetPool); // Copy assignment
+    inline BitsetPool(BitsetPool&& t_BitsetPool) noexcept; // Move constructor
+    inline BitsetPool& operator=(BitsetPool&& t_BitsetPool) noexcept; // Move assignment
+
+    // The views are valid until the pool grows (like the iterators of std::vector)
+    inline BitsetView operator[](const std::size_t t_index) noexcept;
+    inline ConstBitsetView operator[](const std::size_t t_index) const noexcept;
+    inline BitsetView at(const std::size_t t_index);
+    inline ConstBitsetView at(const std::size_t t_index) const;
+
+    // Capacity
+    inline std::size_t size() const noexcept {return m_count;}
+    inline bool empty() const noexcept {return m_count == 0;}
+    inline std::size_t width() const noexcept {return m_width;}
+    // Blocks of each bitset
+    inline std::size_t blocks() const noexcept {return m_stride;}
+    inline std::size_t capacity() const noexcept {return m_capacity;}
+    // All the blocks, the bitset i starts in data() + i * blocks()
+    inline const std::size_t* data() const noexcept {return m_blocks;}
+
+    // Modifiers, push_back returns the index of the new bitset
+    inline std::size_t push_back(const RuntimeBitset& t_bitset);
+    inline std::size_t push_back(const ConstBitsetView& t_bitset);
+    inline std::size_t push_back(); // all 0
+    inline void pop_back() noexcept;
+    inline void resize(const std::size_t t_count); // the new ones are 0
+    inline void reserve(const std::size_t t_count);
+    inline void clear() noexcept {m_count = 0;}
+
+    // Batch members
+    // The number of active bits of each bitset
+    inline std::vector<std::size_t> count_all() const;
+    // The same operation with t_other in every bitset
+    inline BitsetPool& and_with_all(const RuntimeBitset& t_other);
+    inline BitsetPool& or_with_all(const RuntimeBitset& t_other);
+    inline BitsetPool& xor_with_all(const RuntimeBitset& t_other);
+
+  private:
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    inline static constexpr std::size_t ALL_BITS_ONE = ~static_cast<std::size_t>(0);
+
+    // PRIVATE METHODS
+    // Move to a new array of t_capacity bitsets
+    inline void reallocate(const std::size_t t_capacity);
+    inline static std::size_t* allocate(const std::size_t t_blocks);
+    inline static void deallocate(std::size_t* t_blocks) noexcept;
+    // The blocks of t_other, with the no significant bits as 0
+    inline std::vector<std::size_t> blocksOf(const RuntimeBitset& t_other) const;
+    template<typename Operation>
+    inline void applyToAll(const RuntimeBitset& t_other, Operation t_operation);
+
+    // Attributes
+    std::size_t* m_blocks = nullptr;
+    std::size_t m_width = 0;
+    std::size_t m_stride = 0;
+    std::size_t m_count = 0;
+    std::size_t m_capacity = 0;
+};
+
+} // namespace RunBitset
+
+
+// BITSET VIEW
+template<typename Block>
+std::string RunBitset::BasicBitsetView<Block>::to_string() const {
+  std::string toReturn(m_size, '0');
+  for (std::size_t i = find_first(); i < m_size; i = find_next(i + 1)) {
+    toReturn[m_size - 1 - i] = '1'; // the most significant bit is the first character
+  }
+  return toReturn;
+}
+
+template<typename Block>
+RunBitset::RuntimeBitset RunBitset::BasicBitsetView<Block>::toRuntimeBitset() const {
+  RuntimeBitset toReturn(m_size);
+  for (std::size_t i = 0; i < blocks(); ++i) {
+    if (m_blocks[i] != 0) toReturn.setBlock(i, m_blocks[i]);
+  }
+  return toReturn;
+}
+
+template<typename Block>
+bool RunBitset::BasicBitsetView<Block>::operator[](std::size_t t_position) const {
+  return test(t_position);
+}
+
+template<typename Block>
+bool RunBitset::BasicBitsetView<Block>::test(std::size_t t_position) const {
+  checkPosition(t_position);
+  return (m_blocks[t_position / BLOCK_SIZE] >> (t_position % BLOCK_SIZE)) & 1;
+}
+
+template<typename Block>
+bool RunBitset::BasicBitsetView<Block>::all() const noexcept {
+  for (std::size_t i = 0; i < blocks(); ++i) {
+    if (m_blocks[i] != getMask(i)) return false;
+  }
+  return true;
+}
+
+template<typename Block>
+bool RunBitset::BasicBitsetView<Block>::any() const noexcept {
+  return find_first() != m_size;
+}
+
+template<typename Block>
+bool RunBitset::BasicBitsetView<Block>::none() const noexcept {
+  return find_first() == m_size;
+}
+
+template<typename Block>
+std::size_t RunBitset::BasicBitsetView<Block>::count() const noexcept {
+  std::size_t numberOfActive = 0;
+  for (std::size_t i = 0; i < blocks(); ++i) {
+    numberOfActive += std::popcount(m_blocks[i]);
+  }
+  return numberOfActive;
+}
+
+template<typename Block>
+std::size_t RunBitset::BasicBitsetView<Block>::find_first() const noexcept {
+  return find_next(0);
+}
+
+template<typename Block>
+std::size_t RunBitset::BasicBitsetView<Block>::find_next(const std::size_t t_position) const noexcept {
+  if (t_position >= m_size) return m_size;
+  std::size_t block = t_position / BLOCK_SIZE;
+  // Rest of the block of t_position
+  const std::size_t first = m_blocks[block] & (ALL_BITS_ONE << (t_position % BLOCK_SIZE));
+  if (first != 0) return block * BLOCK_SIZE + std::countr_zero(first);
+  for (++block; block < blocks(); ++block) {
+    if (m_blocks[block] != 0) return block * BLOCK_SIZE + std::countr_zero(m_blocks[block]);
+  }
+  return m_size;
+}
+
+template<typename Block>
+std::size_t RunBitset::BasicBitsetView<Block>::getBlock(const std::size_t t_block) const {
+  if (t_block >= blocks()) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  return m_blocks[t_block];
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::setBlock
+(const std::size_t t_block, const std::size_t t_value) requires (!std::is_const_v<Block>) {
+  if (t_block >= blocks()) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  m_blocks[t_block] = t_value & getMask(t_block);
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::set() requires (!std::is_const_v<Block>) {
+  for (std::size_t i = 0; i < blocks(); ++i) {
+    m_blocks[i] = getMask(i);
+  }
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::set
+(const std::size_t t_position) requires (!std::is_const_v<Block>) {
+  checkPosition(t_position);
+  m_blocks[t_position / BLOCK_SIZE] |= (static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE));
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::reset() requires (!std::is_const_v<Block>) {
+  std::fill_n(m_blocks, blocks(), 0);
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::reset
+(const std::size_t t_position) requires (!std::is_const_v<Block>) {
+  checkPosition(t_position);
+  m_blocks[t_position / BLOCK_SIZE] &= ~(static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE));
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::flip() requires (!std::is_const_v<Block>) {
+  for (std::size_t i = 0; i < blocks(); ++i) {
+    m_blocks[i] = ~m_blocks[i] & getMask(i);
+  }
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::flip
+(const std::size_t t_position) requires (!std::is_const_v<Block>) {
+  checkPosition(t_position);
+  m_blocks[t_position / BLOCK_SIZE] ^= (static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE));
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::assign
+(const RuntimeBitset& t_bitset) requires (!std::is_const_v<Block>) {
+  apply(t_bitset, [](const std::size_t, const std::size_t t_2) {return t_2;});
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::operator&=
+(const RuntimeBitset& t_other) requires (!std::is_const_v<Block>) {
+  apply(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 & t_2;});
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::operator|=
+(const RuntimeBitset& t_other) requires (!std::is_const_v<Block>) {
+  apply(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 | t_2;});
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::operator^=
+(const RuntimeBitset& t_other) requires (!std::is_const_v<Block>) {
+  apply(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 ^ t_2;});
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::operator&=
+(const BasicBitsetView<const std::size_t>& t_other) requires (!std::is_const_v<Block>) {
+  apply(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 & t_2;});
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::operator|=
+(const BasicBitsetView<const std::size_t>& t_other) requires (!std::is_const_v<Block>) {
+  apply(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 | t_2;});
+  return *this;
+}
+
+template<typename Block>
+RunBitset::BasicBitsetView<Block>& RunBitset::BasicBitsetView<Block>::operator^=
+(const BasicBitsetView<const std::size_t>& t_other) requires (!std::is_const_v<Block>) {
+  apply(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 ^ t_2;});
+  return *this;
+}
+
+template<typename Block>
+std::size_t RunBitset::BasicBitsetView<Block>::getMask(const std::size_t t_block) const noexcept {
+  return (t_block == blocks() - 1) ? (ALL_BITS_ONE >> (blocks() * BLOCK_SIZE - m_size)) : ALL_BITS_ONE;
+}
+
+template<typename Block>
+void RunBitset::BasicBitsetView<Block>::checkPosition(const std::size_t t_position) const {
+  if (t_position >= m_size) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+}
+
+template<typename Block>
+void RunBitset::BasicBitsetView<Block>::checkSize(const std::size_t t_size) const {
+  if (m_size != t_size) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+}
+
+template<typename Block>
+template<typename Operation>
+void RunBitset::BasicBitsetView<Block>::apply(const RuntimeBitset& t_other, Operation t_operation) {
+  checkSize(t_other.size());
+  for (std::size_t i = 0; i < blocks(); ++i) {
+    m_blocks[i] = t_operation(m_blocks[i], t_other.getBlock(i));
+  }
+}
+
+template<typename Block>
+template<typename Operation>
+void RunBitset::BasicBitsetView<Block>::apply(const BasicBitsetView<const std::size_t>& t_other, Operation t_operation) {
+  checkSize(t_other.size());
+  for (std::size_t i = 0; i < blocks(); ++i) {
+    m_blocks[i] = t_operation(m_blocks[i], t_other.data()[i]);
+  }
+}
+
+// BITSET POOL
+RunBitset::BitsetPool::BitsetPool(const std::size_t t_width, const std::size_t t_count) {
+  // Bitsets of size 0 breaks the implementation
+  if (t_width == 0) throw (RunBitsetException::RuntimeBitsetInvalidSize());
+  m_width = t_width;
+  m_stride = (t_width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  resize(t_count);
+}
+
+RunBitset::BitsetPool::~BitsetPool() {
+  deallocate(m_blocks);
+}
+
+RunBitset::BitsetPool::BitsetPool(const BitsetPool& t_BitsetPool)
+: m_width(t_BitsetPool.m_width), m_stride(t_BitsetPool.m_stride) {
+  reserve(t_BitsetPool.m_count);
+  if (t_BitsetPool.m_count != 0) {
+    std::memcpy(m_blocks, t_BitsetPool.m_blocks, t_BitsetPool.m_count * m_stride * sizeof(std::size_t));
+  }
+  m_count = t_BitsetPool.m_count;
+}
+
+RunBitset::BitsetPool& RunBitset::BitsetPool::operator=(const BitsetPool& t_BitsetPool) {
+  if (this == &t_BitsetPool) return *this;
+  BitsetPool aux(t_BitsetPool); // if the copy fails, this is not modified
+  *this = std::move(aux);
+  return *this;
+}
+
+RunBitset::BitsetPool::BitsetPool(BitsetPool&& t_BitsetPool) noexcept
+: m_blocks(t_BitsetPool.m_blocks), m_width(t_BitsetPool.m_width), m_stride(t_BitsetPool.m_stride),
+  m_count(t_BitsetPool.m_count), m_capacity(t_BitsetPool.m_capacity) {
+  t_BitsetPool.m_blocks = nullptr;
+  t_BitsetPool.m_count = 0;
+  t_BitsetPool.m_capacity = 0;
+}
+
+RunBitset::BitsetPool& RunBitset::BitsetPool::operator=(BitsetPool&& t_BitsetPool) noexcept {
+  if (this == &t_BitsetPool) return *this;
+  deallocate(m_blocks);
+  m_blocks = t_BitsetPool.m_blocks;
+  m_width = t_BitsetPool.m_width;
+  m_stride = t_BitsetPool.m_stride;
+  m_count = t_BitsetPool.m_count;
+  m_capacity = t_BitsetPool.m_capacity;
+  t_BitsetPool.m_blocks = nullptr;
+  t_BitsetPool.m_count = 0;
+  t_BitsetPool.m_capacity = 0;
+  return *this;
+}
+
+RunBitset::BitsetView RunBitset::BitsetPool::operator[](const std::size_t t_index) noexcept {
+  return BitsetView(m_blocks + t_index * m_stride, m_width);
+}
+
+RunBitset::ConstBitsetView RunBitset::BitsetPool::operator[](const std::size_t t_index) const noexcept {
+  return ConstBitsetView(m_blocks + t_index * m_stride, m_width);
+}
+
+RunBitset::BitsetView RunBitset::BitsetPool::at(const std::size_t t_index) {
+  if (t_index >= m_count) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  return (*this)[t_index];
+}
+
+RunBitset::ConstBitsetView RunBitset::BitsetPool::at(const std::size_t t_index) const {
+  if (t_index >= m_count) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  return (*this)[t_index];
+}
+
+std::size_t RunBitset::BitsetPool::push_back(const RuntimeBitset& t_bitset) {
+  if (t_bitset.size() != m_width) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+  const std::size_t index = push_back();
+  (*this)[index].assign(t_bitset);
+  return index;
+}
+
+std::size_t RunBitset::BitsetPool::push_back(const ConstBitsetView& t_bitset) {
+  if (t_bitset.size() != m_width) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+  // t_bitset can be a view of this pool, so it is copied before the pool grows
+  const std::vector<std::size_t> blocks(t_bitset.data(), t_bitset.data() + m_stride);
+  const std::size_t index = push_back();
+  std::copy(blocks.begin(), blocks.end(), m_blocks + index * m_stride);
+  return index;
+}
+
+std::size_t RunBitset::BitsetPool::push_back() {
+  resize(m_count + 1);
+  return m_count - 1;
+}
+
+void RunBitset::BitsetPool::pop_back() noexcept {
+  if (m_count != 0) --m_count;
+}
+
+void RunBitset::BitsetPool::resize(const std::size_t t_count) {
+  if (t_count > m_capacity) reserve(std::max(t_count, m_capacity * 2));
+  if (t_count > m_count) {
+    std::fill(m_blocks + m_count * m_stride, m_blocks + t_count * m_stride, 0);
+  }
+  m_count = t_count;
+}
+
+void RunBitset::BitsetPool::reserve(const std::size_t t_count) {
+  if (t_count > m_capacity) reallocate(t_count);
+}
+
+std::vector<std::size_t> RunBitset::BitsetPool::count_all() const {
+  std::vector<std::size_t> toReturn(m_count);
+  const std::size_t* blocks = m_blocks;
+  for (std::size_t i = 0; i < m_count; ++i, blocks += m_stride) {
+    std::size_t numberOfActive = 0;
+    for (std::size_t j = 0; j < m_stride; ++j) {
+      numberOfActive += std::popcount(blocks[j]);
+    }
+    toReturn[i] = numberOfActive;
+  }
+  return toReturn;
+}
+
+RunBitset::BitsetPool& RunBitset::BitsetPool::and_with_all(const RuntimeBitset& t_other) {
+  applyToAll(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 & t_2;});
+  return *this;
+}
+
+RunBitset::BitsetPool& RunBitset::BitsetPool::or_with_all(const RuntimeBitset& t_other) {
+  applyToAll(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 | t_2;});
+  return *this;
+}
+
+RunBitset::BitsetPool& RunBitset::BitsetPool::xor_with_all(const RuntimeBitset& t_other) {
+  applyToAll(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 ^ t_2;});
+  return *this;
+}
+
+void RunBitset::BitsetPool::reallocate(const std::size_t t_capacity) {
+  std::size_t* blocks = allocate(t_capacity * m_stride);
+  if (m_count != 0) std::memcpy(blocks, m_blocks, m_count * m_stride * sizeof(std::size_t));
+  deallocate(m_blocks);
+  m_blocks = blocks;
+  m_capacity = t_capacity;
+}
+
+std::size_t* RunBitset::BitsetPool::allocate(const std::size_t t_blocks) {
+  return static_cast<std::size_t*>(::operator new(t_blocks * sizeof(std::size_t), std::align_val_t(ALIGNMENT)));
+}
+
+void RunBitset::BitsetPool::deallocate(std::size_t* t_blocks) noexcept {
+  if (t_blocks != nullptr) ::operator delete(t_blocks, std::align_val_t(ALIGNMENT));
+}
+
+std::vector<std::size_t> RunBitset::BitsetPool::blocksOf(const RuntimeBitset& t_other) const {
+  if (t_other.size() != m_width) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+  std::vector<std::size_t> toReturn(m_stride);
+  for (std::size_t i = 0; i < m_stride; ++i) {
+    toReturn[i] = t_other.getBlock(i);
+  }
+  return toReturn;
+}
+
+// The blocks of t_other are copied once, then the pool is visited in order
+template<typename Operation>
+void RunBitset::BitsetPool::applyToAll(const RuntimeBitset& t_other, Operation t_operation) {
+  const std::vector<std::size_t> other = blocksOf(t_other);
+  std::size_t* blocks = m_blocks;
+  for (std::size_t i = 0; i < m_count; ++i, blocks += m_stride) {
+    for (std::size_t j = 0; j < m_stride; ++j) {
+      blocks[j] = t_operation(blocks[j], other[j]);
+    }
+  }
+}
@@ -0,0 +1,518 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, interface of the class DiskBitset, represents
+ *   a bitset stored in a file, with only a few pages of it in memory
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+#include "RuntimeBitsetIO.hpp"
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <future>
+#include <bit>
+#include <algorithm>
+
+namespace RunBitset {
+
+// Bitset stored in a file with the format of BitsetFile, so it can be bigger than the memory
+// The blocks are read by pages of PAGE_BLOCKS, and the last used pages are kept in a cache (LRU)
+// A modified page is written back when it leaves the cache, or in flush()
+// When the pages are read in order, the next READ_AHEAD_PAGES are read in another thread
+// The memory used by the cache and the read ahead is never more than the budget (at least one page),
+//   whatever the size of the bitset
+class DiskBitset {
+  public:
+    // Number of blocks of each page (32 KB with blocks of 64 bits)
+    inline static constexpr std::size_t PAGE_BLOCKS = 4096;
+    inline static constexpr std::size_t READ_AHEAD_PAGES = 8;
+    inline static constexpr std::size_t DEFAULT_BUDGET = 64 * 1024 * 1024; // bytes
+
+    // New file with t_size bits, all 0
+    inline static void create(const std::string& t_path, const std::size_t t_size);
+
+    // SPECIAL MEMBERS
+    // The checksum is not checked here (it would read all the file), BitsetFile::load does it
+    inline explicit DiskBitset(const std::string& t_path, const std::size_t t_budget = DEFAULT_BUDGET);
+    inline ~DiskBitset(); // flush, the errors are ignored (call flush() before to get them)
+    DiskBitset(const DiskBitset&) = delete;
+    DiskBitset& operator=(const DiskBitset&) = delete;
+
+    inline std::string to_string() const;
+    inline RuntimeBitset toRuntimeBitset() const;
+
+    // NORMAL MEMBERS
+    // The const members can read the file too, so all of them can throw RuntimeBitsetFileError
+    inline bool operator[](std::size_t t_position) const;
+    inline bool test(std::size_t t_position) const;
+
+    inline bool all() const;
+    inline bool any() const;
+    inline bool none() const;
+
+    inline std::size_t count() const;
+
+    // Find the first active bit starting in t_position, returns size() if there isn´t any
+    inline std::size_t find_first() const;
+    inline std::size_t find_next(const std::size_t t_position) const;
+
+    // Capacity
+    inline std::size_t size() const noexcept {return m_size;}
+    inline std::size_t blocks() const noexcept {return m_blocks;}
+    inline std::size_t pages() const noexcept {return m_pages;}
+    inline std::size_t cachedPages() const noexcept {return m_cache.size();}
+    // Maximum number of pages in the cache
+    inline std::size_t cacheCapacity() const noexcept {return m_capacity;}
+
+    inline std::size_t getBlock(const std::size_t t_block) const;
+    inline DiskBitset& setBlock(const std::size_t t_block, const std::size_t t_value);
+
+    // Modifiers
+    inline DiskBitset& set();
+    inline DiskBitset& set(const std::size_t t_position);
+    inline DiskBitset& reset();
+    inline DiskBitset& reset(const std::size_t t_position);
+    inline DiskBitset& flip();
+    inline DiskBitset& flip(const std::size_t t_position);
+
+    inline DiskBitset& operator&=(const DiskBitset& t_other);
+    inline DiskBitset& operator|=(const DiskBitset& t_other);
+    inline DiskBitset& operator^=(const DiskBitset& t_other);
+
+    // Write the modified pages and the checksum, after it the file can be loaded with BitsetFile
+    // The checksum needs all the blocks, the pages not cached are read again (with a buffer of one page)
+    inline void flush();
+
+  private:
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    inline static constexpr std::size_t ALL_BITS_ONE = ~static_cast<std::size_t>(0);
+    inline static constexpr std::size_t PAGE_BYTES = PAGE_BLOCKS * sizeof(std::size_t);
+
+    struct Page {
+      std::vector<std::size_t> blocks; // the last page can be shorter
+      bool dirty = false;
+      std::list<std::size_t>::iterator position; // in m_recent
+    };
+
+    // PRIVATE METHODS
+    // The page t_page, read if it is not in the cache. It becomes the most recently used
+    inline Page& getPage(const std::size_t t_page) const;
+    inline Page& getWritablePage(const std::size_t t_page);
+    inline Page& insertPage(const std::size_t t_page, std::vector<std::size_t>&& t_blocks) const;
+    // Remove the least recently used pages until there is room for another one
+    inline void evict() const;
+    inline void writePage(const std::size_t t_page, const std::vector<std::size_t>& t_blocks) const;
+    // Read and convert from little endian
+    inline void readBlocks(const std::size_t t_first, const std::size_t t_count, std::size_t* t_buffer) const;
+    // Start reading the pages from t_page in another thread
+    inline void startReadAhead(const std::size_t t_page) const;
+    // Wait for the pages read ahead and move them to the cache
+    inline void installReadAhead() const;
+    // Wait for the pages read ahead and discard them
+    inline void cancelReadAhead() const noexcept;
+    inline bool isReadAhead(const std::size_t t_page) const noexcept;
+    // All the blocks with t_value, the pages not cached are written directly
+    inline void fill(const std::size_t t_value);
+    inline std::size_t pageBlocks(const std::size_t t_page) const noexcept;
+    inline std::size_t getMask(const std::size_t t_block) const noexcept;
+    inline void checkPosition(const std::size_t t_position) const;
+    inline void checkSize(const DiskBitset& t_other) const;
+    template<typename Operation>
+    inline void binaryOperation(const DiskBitset& t_other, Operation t_operation);
+
+    // Attributes
+    mutable PositionalFile m_file;
+    std::size_t m_size = 0;
+    std::size_t m_blocks = 0;
+    std::size_t m_pages = 0;
+    std::size_t m_lastMask = 0; // mask of the most significant block
+    std::size_t m_capacity = 0; // pages
+    std::size_t m_readAheadPages = 0;
+    bool m_modified = false; // the checksum of the file is no longer valid
+    mutable std::unordered_map<std::size_t, Page> m_cache;
+    mutable std::list<std::size_t> m_recent; // most recently used first
+    // Last page read from the file, a read of the next one is a sequential read
+    //   (starts at -1, so reading the page 0 first is sequential too)
+    mutable std::size_t m_lastRead = ~static_cast<std::size_t>(0);
+    mutable std::vector<std::size_t> m_staged; // pages read ahead
+    mutable std::size_t m_stagedFirst = 0;
+    mutable std::size_t m_stagedCount = 0;
+    // The last one, so it is waited before the rest is destroyed
+    mutable std::future<void> m_readAhead;
+};
+
+} // namespace RunBitset
+
+
+void RunBitset::DiskBitset::create(const std::string& t_path, const std::size_t t_size) {
+  if (t_size == 0) throw (RunBitsetException::RuntimeBitsetInvalidSize());
+  const std::size_t blocks = (t_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  PositionalFile file(t_path, PositionalFile::CREATE);
+  const std::uint64_t header[BitsetFile::HEADER_WORDS] = {BitsetFile::toLittleEndian(BitsetFile::MAGIC),
+    BitsetFile::toLittleEndian(t_size), BitsetFile::toLittleEndian(blocks)};
+  file.writeAt(0, header, sizeof(header));
+  const std::vector<std::size_t> zeros(std::min(BitsetFile::CHUNK_BLOCKS, blocks), 0);
+  std::uint64_t hash = BitsetFile::HASH_OFFSET;
+  for (std::size_t first = 0; first < blocks; first += zeros.size()) {
+    const std::size_t count = std::min(zeros.size(), blocks - first);
+    hash = BitsetFile::checksum(hash, zeros.data(), count);
+    file.writeAt(BitsetFile::blocksOffset(first), zeros.data(), count * sizeof(std::size_t));
+  }
+  const std::uint64_t trailer = BitsetFile::toLittleEndian(hash);
+  file.writeAt(BitsetFile::blocksOffset(blocks), &trailer, sizeof(trailer));
+}
+
+RunBitset::DiskBitset::DiskBitset(const std::string& t_path, const std::size_t t_budget)
+: m_file(t_path, PositionalFile::UPDATE) {
+  m_size = BitsetFile::readHeader(m_file);
+  m_blocks = (m_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  m_pages = (m_blocks + PAGE_BLOCKS - 1) / PAGE_BLOCKS;
+  m_lastMask = ALL_BITS_ONE >> (m_blocks * BLOCK_SIZE - m_size);
+  // The read ahead takes at most half of the budget
+  const std::size_t budget = std::max<std::size_t>(t_budget / PAGE_BYTES, 1);
+  m_readAheadPages = std::min(READ_AHEAD_PAGES, budget / 2);
+  m_capacity = budget - m_readAheadPages;
+}
+
+RunBitset::DiskBitset::~DiskBitset() {
+  try {
+    flush();
+  }
+  catch (...) {} // a destructor can´t throw
+  cancelReadAhead();
+}
+
+std::string RunBitset::DiskBitset::to_string() const {
+  std::string toReturn(m_size, '0');
+  for (std::size_t i = find_first(); i < m_size; i = find_next(i + 1)) {
+    toReturn[m_size - 1 - i] = '1'; // the most significant bit is the first character
+  }
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::DiskBitset::toRuntimeBitset() const {
+  RuntimeBitset toReturn(m_size);
+  for (std::size_t p = 0; p < m_pages; ++p) {
+    const Page& page = getPage(p);
+    for (std::size_t i = 0; i < page.blocks.size(); ++i) {
+      if (page.blocks[i] != 0) toReturn.setBlock(p * PAGE_BLOCKS + i, page.blocks[i]);
+    }
+  }
+  return toReturn;
+}
+
+bool RunBitset::DiskBitset::operator[](std::size_t t_position) const {
+  return test(t_position);
+}
+
+bool RunBitset::DiskBitset::test(std::size_t t_position) const {
+  checkPosition(t_position);
+  return (getBlock(t_position / BLOCK_SIZE) >> (t_position % BLOCK_SIZE)) & 1;
+}
+
+bool RunBitset::DiskBitset::all() const {
+  for (std::size_t p = 0; p < m_pages; ++p) {
+    const Page& page = getPage(p);
+    for (std::size_t i = 0; i < page.blocks.size(); ++i) {
+      if (page.blocks[i] != getMask(p * PAGE_BLOCKS + i)) return false;
+    }
+  }
+  return true;
+}
+
+bool RunBitset::DiskBitset::any() const {
+  return find_first() != m_size;
+}
+
+bool RunBitset::DiskBitset::none() const {
+  return find_first() == m_size;
+}
+
+std::size_t RunBitset::DiskBitset::count() const {
+  std::size_t numberOfActive = 0;
+  for (std::size_t p = 0; p < m_pages; ++p) {
+    for (const std::size_t block : getPage(p).blocks) {
+      numberOfActive += std::popcount(block);
+    }
+  }
+  return numberOfActive;
+}
+
+std::size_t RunBitset::DiskBitset::find_first() const {
+  return find_next(0);
+}
+
+std::size_t RunBitset::DiskBitset::find_next(const std::size_t t_position) const {
+  if (t_position >= m_size) return m_size;
+  std::size_t block = t_position / BLOCK_SIZE;
+  // Rest of the block of t_position
+  const std::size_t first = getBlock(block) & (ALL_BITS_ONE << (t_position % BLOCK_SIZE));
+  if (first != 0) return block * BLOCK_SIZE + std::countr_zero(first);
+  for (++block; block < m_blocks;) {
+    const Page& page = getPage(block / PAGE_BLOCKS);
+    const std::size_t last = std::min((block / PAGE_BLOCKS + 1) * PAGE_BLOCKS, m_blocks);
+    for (; block < last; ++block) {
+      const std::size_t value = page.blocks[block % PAGE_BLOCKS];
+      if (value != 0) return block * BLOCK_SIZE + std::countr_zero(value);
+    }
+  }
+  return m_size;
+}
+
+std::size_t RunBitset::DiskBitset::getBlock(const std::size_t t_block) const {
+  if (t_block >= m_blocks) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  return getPage(t_block / PAGE_BLOCKS).blocks[t_block % PAGE_BLOCKS];
+}
+
+RunBitset::DiskBitset& RunBitset::DiskBitset::setBlock(const std::size_t t_block, const std::size_t t_value) {
+  if (t_block >= m_blocks) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  getWritablePage(t_block / PAGE_BLOCKS).blocks[t_block % PAGE_BLOCKS] = t_value & getMask(t_block);
+  return *this;
+}
+
+RunBitset::DiskBitset& RunBitset::DiskBitset::set() {
+  fill(ALL_BITS_ONE);
+  return *this;
+}
+
+RunBitset::DiskBitset& RunBitset::DiskBitset::set(const std::size_t t_position) {
+  checkPosition(t_position);
+  const std::size_t block = t_position / BLOCK_SIZE;
+  getWritablePage(block / PAGE_BLOCKS).blocks[block % PAGE_BLOCKS] |= (static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE));
+  return *this;
+}
+
+RunBitset::DiskBitset& RunBitset::DiskBitset::reset() {
+  fill(0);
+  return *this;
+}
+
+RunBitset::DiskBitset& RunBitset::DiskBitset::reset(const std::size_t t_position) {
+  checkPosition(t_position);
+  const std::size_t block = t_position / BLOCK_SIZE;
+  getWritablePage(block / PAGE_BLOCKS).blocks[block % PAGE_BLOCKS] &= ~(static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE));
+  return *this;
+}
+
+RunBitset::DiskBitset& RunBitset::DiskBitset::flip() {
+  for (std::size_t p = 0; p < m_pages; ++p) {
+    std::vector<std::size_t>& blocks = getWritablePage(p).blocks;
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+      blocks[i] = ~blocks[i] & getMask(p * PAGE_BLOCKS + i);
+    }
+  }
+  return *this;
+}
+
+RunBitset::DiskBitset& RunBitset::DiskBitset::flip(const std::size_t t_position) {
+  checkPosition(t_position);
+  const std::size_t block = t_position / BLOCK_SIZE;
+  getWritablePage(block / PAGE_BLOCKS).blocks[block % PAGE_BLOCKS] ^= (static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE));
+  return *this;
+}
+
+RunBitset::DiskBitset& RunBitset::DiskBitset::operator&=(const DiskBitset& t_other) {
+  binaryOperation(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 & t_2;});
+  return *this;
+}
+
+RunBitset::DiskBitset& RunBitset::DiskBitset::operator|=(const DiskBitset& t_other) {
+  binaryOperation(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 | t_2;});
+  return *this;
+}
+
+RunBitset::DiskBitset& RunBitset::DiskBitset::operator^=(const DiskBitset& t_other) {
+  binaryOperation(t_other, [](const std::size_t t_1, const std::size_t t_2) {return t_1 ^ t_2;});
+  return *this;
+}
+
+void RunBitset::DiskBitset::flush() {
+  for (auto& [index, page] : m_cache) {
+    if (!page.dirty) continue;
+    writePage(index, page.blocks);
+    page.dirty = false;
+  }
+  if (!m_modified) return;
+  std::vector<std::size_t> buffer;
+  std::uint64_t hash = BitsetFile::HASH_OFFSET;
+  for (std::size_t p = 0; p < m_pages; ++p) {
+    // Without getPage, so the cache and the order of use are not changed
+    const auto found = m_cache.find(p);
+    if (found != m_cache.end()) {
+      hash = BitsetFile::checksum(hash, found->second.blocks.data(), found->second.blocks.size());
+      continue;
+    }
+    buffer.resize(pageBlocks(p));
+    readBlocks(p * PAGE_BLOCKS, buffer.size(), buffer.data());
+    hash = BitsetFile::checksum(hash, buffer.data(), buffer.size());
+  }
+  const std::uint64_t trailer = BitsetFile::toLittleEndian(hash);
+  m_file.writeAt(BitsetFile::blocksOffset(m_blocks), &trailer, sizeof(trailer));
+  m_modified = false;
+}
+
+RunBitset::DiskBitset::Page& RunBitset::DiskBitset::getPage(const std::size_t t_page) const {
+  const auto found = m_cache.find(t_page);
+  if (found != m_cache.end()) {
+    m_recent.splice(m_recent.begin(), m_recent, found->second.position);
+    return found->second;
+  }
+  if (isReadAhead(t_page)) {
+    const std::size_t next = m_stagedFirst + m_stagedCount;
+    installReadAhead();
+    startReadAhead(next); // the scan goes on, so the next pages are read while these are used
+    return getPage(t_page); // in the cache now
+  }
+  std::vector<std::size_t> blocks(pageBlocks(t_page));
+  readBlocks(t_page * PAGE_BLOCKS, blocks.size(), blocks.data());
+  const bool sequential = (t_page == m_lastRead + 1);
+  m_lastRead = t_page;
+  Page& page = insertPage(t_page, std::move(blocks));
+  if (sequential) startReadAhead(t_page + 1);
+  return page;
+}
+
+RunBitset::DiskBitset::Page& RunBitset::DiskBitset::getWritablePage(const std::size_t t_page) {
+  Page& page = getPage(t_page);
+  page.dirty = true;
+  m_modified = true;
+  return page;
+}
+
+RunBitset::DiskBitset::Page& RunBitset::DiskBitset::insertPage
+(const std::size_t t_page, std::vector<std::size_t>&& t_blocks) const {
+  evict();
+  Page& page = m_cache[t_page];
+  page.blocks = std::move(t_blocks);
+  page.dirty = false;
+  m_recent.push_front(t_page);
+  page.position = m_recent.begin();
+  return page;
+}
+
+void RunBitset::DiskBitset::evict() const {
+  while (m_cache.size() >= m_capacity) {
+    const auto found = m_cache.find(m_recent.back());
+    if (found->second.dirty) writePage(found->first, found->second.blocks);
+    m_recent.pop_back();
+    m_cache.erase(found);
+  }
+}
+
+void RunBitset::DiskBitset::writePage(const std::size_t t_page, const std::vector<std::size_t>& t_blocks) const {
+  // The pages read ahead would have the old value
+  if (isReadAhead(t_page)) cancelReadAhead();
+  const std::uint64_t offset = BitsetFile::blocksOffset(t_page * PAGE_BLOCKS);
+  if constexpr (std::endian::native == std::endian::little) {
+    m_file.writeAt(offset, t_blocks.data(), t_blocks.size() * sizeof(std::size_t));
+  }
+  else {
+    std::vector<std::size_t> buffer(t_blocks.size());
+    std::transform(t_blocks.begin(), t_blocks.end(), buffer.begin(), BitsetFile::toLittleEndian);
+    m_file.writeAt(offset, buffer.data(), buffer.size() * sizeof(std::size_t));
+  }
+}
+
+void RunBitset::DiskBitset::readBlocks
+(const std::size_t t_first, const std::size_t t_count, std::size_t* t_buffer) const {
+  m_file.readAt(BitsetFile::blocksOffset(t_first), t_buffer, t_count * sizeof(std::size_t));
+  for (std::size_t i = 0; i < t_count; ++i) {
+    t_buffer[i] = BitsetFile::toLittleEndian(t_buffer[i]);
+  }
+}
+
+void RunBitset::DiskBitset::startReadAhead(const std::size_t t_page) const {
+  cancelReadAhead(); // only one at the same time
+  if (m_readAheadPages == 0 || t_page >= m_pages) return;
+  m_staged.resize(m_readAheadPages * PAGE_BLOCKS);
+  m_stagedFirst = t_page;
+  m_stagedCount = std::min(m_readAheadPages, m_pages - t_page);
+  // The pages are consecutive in the file, so only one read
+  const std::size_t first = t_page * PAGE_BLOCKS;
+  const std::size_t count = std::min((t_page + m_stagedCount) * PAGE_BLOCKS, m_blocks) - first;
+  m_readAhead = std::async(std::launch::async, [this, first, count]() {
+    readBlocks(first, count, m_staged.data());
+  });
+}
+
+void RunBitset::DiskBitset::installReadAhead() const {
+  const std::size_t first = m_stagedFirst;
+  const std::size_t count = m_stagedCount;
+  m_stagedCount = 0;
+  m_readAhead.get(); // throws the error of the read if any
+  for (std::size_t p = first; p < first + count; ++p) {
+    if (m_cache.find(p) != m_cache.end()) continue; // the cached page is newer
+    const std::size_t* blocks = m_staged.data() + (p - first) * PAGE_BLOCKS;
+    insertPage(p, std::vector<std::size_t>(blocks, blocks + pageBlocks(p)));
+  }
+  m_lastRead = first + count - 1;
+}
+
+void RunBitset::DiskBitset::cancelReadAhead() const noexcept {
+  m_stagedCount = 0;
+  if (!m_readAhead.valid()) return;
+  try {
+    m_readAhead.get();
+  }
+  catch (...) {} // nobody is going to use these pages
+}
+
+bool RunBitset::DiskBitset::isReadAhead(const std::size_t t_page) const noexcept {
+  return m_stagedCount != 0 && t_page >= m_stagedFirst && t_page < m_stagedFirst + m_stagedCount;
+}
+
+void RunBitset::DiskBitset::fill(const std::size_t t_value) {
+  cancelReadAhead();
+  std::vector<std::size_t> buffer;
+  for (std::size_t p = 0; p < m_pages; ++p) {
+    buffer.assign(pageBlocks(p), t_value);
+    if (p == m_pages - 1) buffer.back() &= m_lastMask;
+    const auto found = m_cache.find(p);
+    if (found != m_cache.end()) {
+      found->second.blocks = buffer;
+      found->second.dirty = true;
+    }
+    else {
+      writePage(p, buffer); // no need to read it
+    }
+  }
+  m_modified = true;
+}
+
+std::size_t RunBitset::DiskBitset::pageBlocks(const std::size_t t_page) const noexcept {
+  return std::min(PAGE_BLOCKS, m_blocks - t_page * PAGE_BLOCKS);
+}
+
+std::size_t RunBitset::DiskBitset::getMask(const std::size_t t_block) const noexcept {
+  return (t_block == m_blocks - 1) ? m_lastMask : ALL_BITS_ONE;
+}
+
+void RunBitset::DiskBitset::checkPosition(const std::size_t t_position) const {
+  if (t_position >= m_size) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+}
+
+void RunBitset::DiskBitset::checkSize(const DiskBitset& t_other) const {
+  if (m_size != t_other.m_size) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+}
+
+// Page by page, both bitsets are read in order, so both use the read ahead
+template<typename Operation>
+void RunBitset::DiskBitset::binaryOperation(const DiskBitset& t_other, Operation t_operation) {
+  checkSize(t_other);
+  for (std::size_t p = 0; p < m_pages; ++p) {
+    const std::vector<std::size_t>& other = t_other.getPage(p).blocks;
+    std::vector<std::size_t>& blocks = getWritablePage(p).blocks;
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+      blocks[i] = t_operation(blocks[i], other[i]);
+    }
+  }
+}
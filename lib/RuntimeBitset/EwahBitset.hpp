@@ -0,0 +1,382 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, interface of the class EwahBitset, represents
+ *   an inmutable bitset compressed with EWAH (enhanced word aligned hybrid)
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+
+#include <string>
+#include <cstddef>
+#include <vector>
+#include <bit>
+#include <algorithm>
+
+namespace RunBitset {
+
+// The blocks are stored as a sequence of markers, each one followed by its literal blocks
+// Marker: bit 0 the value of the run, then the number of blocks of the run (all 0 or all 1),
+//   then the number of literal blocks that follow the marker (blocks stored as they are)
+// The operations work directly with the runs and the literals, a run is processed at once
+class EwahBitset {
+  public:
+    // SPECIAL MEMBERS
+    inline EwahBitset(const std::size_t t_size);
+    inline EwahBitset(const RuntimeBitset& t_bitset);
+    inline EwahBitset(); // Default constructor
+    ~EwahBitset() = default;
+    EwahBitset(const EwahBitset&) = default;
+    EwahBitset& operator=(const EwahBitset&) = default;
+    EwahBitset(EwahBitset&&) = default;
+    EwahBitset& operator=(EwahBitset&&) = default;
+
+    inline std::string to_string() const;
+    inline RuntimeBitset toRuntimeBitset() const;
+
+    // NORMAL MEMBERS
+    // Linear in the compressed size
+    inline bool operator[](std::size_t t_position) const;
+    inline bool test(std::size_t t_position) const;
+
+    inline bool all() const noexcept;
+    inline bool any() const noexcept;
+    inline bool none() const noexcept;
+
+    inline std::size_t count() const noexcept;
+
+    // Capacity
+    inline std::size_t size() const noexcept {return m_size;}
+    // Number of words of the compressed stream (markers and literals)
+    inline std::size_t compressedWords() const noexcept {return m_words.size();}
+
+    // Compressed domain operations
+    friend inline EwahBitset operator&(const EwahBitset& t_1, const EwahBitset& t_2);
+    friend inline EwahBitset operator|(const EwahBitset& t_1, const EwahBitset& t_2);
+    friend inline EwahBitset operator^(const EwahBitset& t_1, const EwahBitset& t_2);
+    // t_1 & ~t_2
+    friend inline EwahBitset andNot(const EwahBitset& t_1, const EwahBitset& t_2);
+    inline EwahBitset& operator&=(const EwahBitset& t_other);
+    inline EwahBitset& operator|=(const EwahBitset& t_other);
+    inline EwahBitset& operator^=(const EwahBitset& t_other);
+
+  private:
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    inline static constexpr std::size_t ALL_BITS_ONE = ~static_cast<std::size_t>(0);
+    // Half of the marker for the run, the other half (minus the run bit) for the literals
+    inline static constexpr std::size_t RUN_BITS = BLOCK_SIZE / 2;
+    inline static constexpr std::size_t LITERAL_BITS = BLOCK_SIZE / 2 - 1;
+    inline static constexpr std::size_t MAX_RUN = (static_cast<std::size_t>(1) << RUN_BITS) - 1;
+    inline static constexpr std::size_t MAX_LITERALS = (static_cast<std::size_t>(1) << LITERAL_BITS) - 1;
+
+    // Reads the stream block by block, or run by run
+    class Reader {
+      public:
+        explicit Reader(const std::vector<std::size_t>& t_words) : m_words(t_words) {}
+        // Load the next marker if the current one is consumed, false at the end
+        inline bool next() noexcept;
+        inline void skip(const std::size_t t_blocks) noexcept;
+        inline std::size_t literal() const noexcept {return m_words[m_literal];}
+        inline std::size_t fill() const noexcept {return m_runBit ? ALL_BITS_ONE : 0;}
+
+        std::size_t m_run = 0; // blocks left in the run
+        std::size_t m_literals = 0; // literal blocks left
+      private:
+        const std::vector<std::size_t>& m_words;
+        std::size_t m_position = 0; // next marker
+        std::size_t m_literal = 0; // current literal
+        bool m_runBit = false;
+    };
+
+    // PRIVATE METHODS
+    inline void build(const std::size_t t_size);
+    // Append t_blocks blocks all 0 or all 1
+    inline void addRun(const bool t_bit, std::size_t t_blocks);
+    // Append a block, it is added as a run if it is all 0 or all 1
+    inline void addLiteral(const std::size_t t_block);
+    inline void addMarker();
+    // Apply t_function to each run (value, first block, blocks) and literal (block, value)
+    template <typename RunFunction, typename LiteralFunction>
+    inline void forEach(RunFunction t_run, LiteralFunction t_literal) const;
+    // Merge both streams, t_operation is applied to the blocks (or to a run only once)
+    template <typename Operation>
+    inline static EwahBitset binaryOperation(const EwahBitset& t_1, const EwahBitset& t_2, Operation t_operation);
+    inline void checkPosition(const std::size_t t_position) const;
+
+    // Attributes
+    std::vector<std::size_t> m_words; // markers and literals, little endian
+    std::size_t m_lastMarker = 0; // position of the marker that is being filled
+    std::size_t m_size = 0;
+    std::size_t m_blocks = 0;
+};
+
+} // namespace RunBitset
+
+
+namespace RunBitset {
+
+EwahBitset operator&(const EwahBitset& t_1, const EwahBitset& t_2) {
+  return EwahBitset::binaryOperation(t_1, t_2, [](std::size_t t_a, std::size_t t_b) {return t_a & t_b;});
+}
+
+EwahBitset operator|(const EwahBitset& t_1, const EwahBitset& t_2) {
+  return EwahBitset::binaryOperation(t_1, t_2, [](std::size_t t_a, std::size_t t_b) {return t_a | t_b;});
+}
+
+EwahBitset operator^(const EwahBitset& t_1, const EwahBitset& t_2) {
+  return EwahBitset::binaryOperation(t_1, t_2, [](std::size_t t_a, std::size_t t_b) {return t_a ^ t_b;});
+}
+
+EwahBitset andNot(const EwahBitset& t_1, const EwahBitset& t_2) {
+  return EwahBitset::binaryOperation(t_1, t_2, [](std::size_t t_a, std::size_t t_b) {return t_a & ~t_b;});
+}
+
+}
+
+RunBitset::EwahBitset::EwahBitset(const std::size_t t_size) {
+  build(t_size);
+  addRun(false, m_blocks);
+}
+
+RunBitset::EwahBitset::EwahBitset(const RuntimeBitset& t_bitset) {
+  build(t_bitset.size());
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    addLiteral(t_bitset.getBlock(i)); // the no significant bits are always 0
+  }
+}
+
+RunBitset::EwahBitset::EwahBitset() {
+  build(BLOCK_SIZE);
+  addRun(false, m_blocks);
+}
+
+std::string RunBitset::EwahBitset::to_string() const {
+  std::string toReturn(m_size, '0');
+  auto setBit = [&](const std::size_t t_position) {
+    toReturn[m_size - 1 - t_position] = '1'; // the most significant bit is the first character
+  };
+  forEach(
+    [&](const bool t_bit, const std::size_t t_first, const std::size_t t_blocks) {
+      if (!t_bit) return;
+      for (std::size_t i = t_first * BLOCK_SIZE; i < (t_first + t_blocks) * BLOCK_SIZE; ++i) setBit(i);
+    },
+    [&](const std::size_t t_block, std::size_t t_value) {
+      for (; t_value != 0; t_value &= t_value - 1) setBit(t_block * BLOCK_SIZE + std::countr_zero(t_value));
+    });
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::EwahBitset::toRuntimeBitset() const {
+  RuntimeBitset toReturn(m_size);
+  forEach(
+    [&](const bool t_bit, const std::size_t t_first, const std::size_t t_blocks) {
+      if (!t_bit) return;
+      for (std::size_t i = t_first; i < t_first + t_blocks; ++i) toReturn.setBlock(i, ALL_BITS_ONE);
+    },
+    [&](const std::size_t t_block, const std::size_t t_value) {toReturn.setBlock(t_block, t_value);});
+  return toReturn;
+}
+
+bool RunBitset::EwahBitset::operator[](std::size_t t_position) const {
+  return test(t_position);
+}
+
+bool RunBitset::EwahBitset::test(std::size_t t_position) const {
+  checkPosition(t_position);
+  const std::size_t block = t_position / BLOCK_SIZE;
+  Reader reader(m_words);
+  std::size_t current = 0; // first block not read
+  while (reader.next()) {
+    if (reader.m_run > 0) {
+      if (block < current + reader.m_run) return reader.fill() != 0;
+      current += reader.m_run;
+      reader.skip(reader.m_run);
+      continue;
+    }
+    if (block < current + reader.m_literals) {
+      reader.skip(block - current);
+      return (reader.literal() >> (t_position % BLOCK_SIZE)) & 1;
+    }
+    current += reader.m_literals;
+    reader.skip(reader.m_literals);
+  }
+  return false;
+}
+
+bool RunBitset::EwahBitset::all() const noexcept {
+  return count() == m_size;
+}
+
+bool RunBitset::EwahBitset::any() const noexcept {
+  return count() != 0;
+}
+
+bool RunBitset::EwahBitset::none() const noexcept {
+  return count() == 0;
+}
+
+// A run of 1 is counted at once, the no significant bits are never 1
+std::size_t RunBitset::EwahBitset::count() const noexcept {
+  std::size_t numberOfActive = 0;
+  forEach(
+    [&](const bool t_bit, const std::size_t, const std::size_t t_blocks) {
+      if (t_bit) numberOfActive += t_blocks * BLOCK_SIZE;
+    },
+    [&](const std::size_t, const std::size_t t_value) {numberOfActive += std::popcount(t_value);});
+  return numberOfActive;
+}
+
+RunBitset::EwahBitset& RunBitset::EwahBitset::operator&=(const EwahBitset& t_other) {
+  *this = *this & t_other;
+  return *this;
+}
+
+RunBitset::EwahBitset& RunBitset::EwahBitset::operator|=(const EwahBitset& t_other) {
+  *this = *this | t_other;
+  return *this;
+}
+
+RunBitset::EwahBitset& RunBitset::EwahBitset::operator^=(const EwahBitset& t_other) {
+  *this = *this ^ t_other;
+  return *this;
+}
+
+void RunBitset::EwahBitset::build(const std::size_t t_size) {
+  // Bitsets of size 0 breaks the implementation
+  if (t_size == 0) throw (RunBitsetException::RuntimeBitsetInvalidSize());
+  m_size = t_size;
+  m_blocks = (t_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  m_words.clear();
+  m_lastMarker = 0;
+}
+
+void RunBitset::EwahBitset::addMarker() {
+  m_lastMarker = m_words.size();
+  m_words.push_back(0);
+}
+
+// The run is added to the last marker if it doesn´t have literals yet and it is of the same bit
+void RunBitset::EwahBitset::addRun(const bool t_bit, std::size_t t_blocks) {
+  while (t_blocks > 0) {
+    if (m_words.empty()) addMarker();
+    std::size_t& marker = m_words[m_lastMarker];
+    const std::size_t run = (marker >> 1) & MAX_RUN;
+    const std::size_t literals = marker >> (RUN_BITS + 1);
+    const bool sameRun = (run == 0 || static_cast<bool>(marker & 1) == t_bit);
+    if (literals != 0 || !sameRun || run == MAX_RUN) {
+      addMarker();
+      continue;
+    }
+    const std::size_t added = std::min(t_blocks, MAX_RUN - run);
+    marker = (static_cast<std::size_t>(t_bit)) | ((run + added) << 1);
+    t_blocks -= added;
+  }
+}
+
+void RunBitset::EwahBitset::addLiteral(const std::size_t t_block) {
+  if (t_block == 0 || t_block == ALL_BITS_ONE) {
+    addRun(t_block != 0, 1);
+    return;
+  }
+  if (m_words.empty() || (m_words[m_lastMarker] >> (RUN_BITS + 1)) == MAX_LITERALS) addMarker();
+  m_words[m_lastMarker] += static_cast<std::size_t>(1) << (RUN_BITS + 1);
+  m_words.push_back(t_block);
+}
+
+bool RunBitset::EwahBitset::Reader::next() noexcept {
+  while (m_run == 0 && m_literals == 0) {
+    if (m_position >= m_words.size()) return false;
+    const std::size_t marker = m_words[m_position];
+    m_runBit = marker & 1;
+    m_run = (marker >> 1) & MAX_RUN;
+    m_literals = marker >> (RUN_BITS + 1);
+    m_literal = m_position + 1;
+    m_position += 1 + m_literals;
+  }
+  return true;
+}
+
+// First the run, then the literals
+void RunBitset::EwahBitset::Reader::skip(std::size_t t_blocks) noexcept {
+  const std::size_t fromRun = std::min(t_blocks, m_run);
+  m_run -= fromRun;
+  t_blocks -= fromRun;
+  m_literals -= t_blocks;
+  m_literal += t_blocks;
+}
+
+template <typename RunFunction, typename LiteralFunction>
+void RunBitset::EwahBitset::forEach(RunFunction t_run, LiteralFunction t_literal) const {
+  Reader reader(m_words);
+  std::size_t current = 0;
+  while (reader.next()) {
+    if (reader.m_run > 0) {
+      t_run(reader.fill() != 0, current, reader.m_run);
+      current += reader.m_run;
+      reader.skip(reader.m_run);
+      continue;
+    }
+    t_literal(current, reader.literal());
+    ++current;
+    reader.skip(1);
+  }
+}
+
+// Run with run: one run in the result
+// Run with literals: if the run decides the result (a & 0, a | 1) it is one run,
+//   if not, the literals are operated with the value of the run
+template <typename Operation>
+RunBitset::EwahBitset RunBitset::EwahBitset::binaryOperation
+(const EwahBitset& t_1, const EwahBitset& t_2, Operation t_operation) {
+  if (t_1.m_size != t_2.m_size) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+  EwahBitset toReturn;
+  toReturn.build(t_1.m_size);
+  Reader reader1(t_1.m_words);
+  Reader reader2(t_2.m_words);
+  while (reader1.next() && reader2.next()) {
+    if (reader1.m_run > 0 && reader2.m_run > 0) {
+      const std::size_t blocks = std::min(reader1.m_run, reader2.m_run);
+      toReturn.addRun(t_operation(reader1.fill(), reader2.fill()) != 0, blocks);
+      reader1.skip(blocks);
+      reader2.skip(blocks);
+      continue;
+    }
+    if (reader1.m_run > 0 || reader2.m_run > 0) {
+      const bool firstIsRun = reader1.m_run > 0;
+      Reader& run = firstIsRun ? reader1 : reader2;
+      Reader& literals = firstIsRun ? reader2 : reader1;
+      const std::size_t blocks = std::min(run.m_run, literals.m_literals);
+      auto apply = [&](const std::size_t t_literal) {
+        return firstIsRun ? t_operation(run.fill(), t_literal) : t_operation(t_literal, run.fill());
+      };
+      const std::size_t withZero = apply(0);
+      if (withZero == apply(ALL_BITS_ONE) && (withZero == 0 || withZero == ALL_BITS_ONE)) {
+        toReturn.addRun(withZero != 0, blocks);
+        literals.skip(blocks);
+      }
+      else {
+        for (std::size_t i = 0; i < blocks; ++i) {
+          toReturn.addLiteral(apply(literals.literal()));
+          literals.skip(1);
+        }
+      }
+      run.skip(blocks);
+      continue;
+    }
+    const std::size_t blocks = std::min(reader1.m_literals, reader2.m_literals);
+    for (std::size_t i = 0; i < blocks; ++i) {
+      toReturn.addLiteral(t_operation(reader1.literal(), reader2.literal()));
+      reader1.skip(1);
+      reader2.skip(1);
+    }
+  }
+  return toReturn;
+}
+
+void RunBitset::EwahBitset::checkPosition(const std::size_t t_position) const {
+  if (t_position >= m_size) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+}
@@ -0,0 +1,466 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, interface of the class HammingIndex, nearest neighbours by Hamming distance
+ *   between a query and the bitsets of a BitsetPool
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+#include "BitsetPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <bit>
+#include <exception>
+#include <system_error>
+
+// Popcount of the XOR of 8 blocks at a time with AVX-512 (VPOPCNTDQ, and of 4 blocks with VL), only with
+//   blocks of 64 bits. Not AVX2: counting the nibbles with shuffles is not faster than popcnt block by block
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__) && defined(__x86_64__) && !defined(__ILP32__)
+#include <immintrin.h>
+#define RUNBITSET_AVX512_POPCOUNT
+#endif
+
+namespace RunBitset {
+
+// Search by Hamming distance (popcount of the XOR) in the bitsets of a BitsetPool
+// Without multi index, every query goes through all the pool in order, split between t_threads threads
+// With buildMultiIndex(m), the bits are split in m substrings, and the bitsets are sorted by each substring
+//   A bitset at distance d has a substring at distance d / m or less, so only the bitsets with
+//   a substring near the one of the query are checked. Good with small distances, else it goes back to the scan
+// The pool is not copied, it must outlive the index. After buildMultiIndex(), the bitsets added to the pool
+//   are still found (with the scan), but the old ones must not be modified
+class HammingIndex {
+  public:
+    struct Neighbour {
+      std::size_t index; // in the pool
+      std::size_t distance;
+    };
+
+    // Each thread scans at least PARALLEL_MIN bitsets, less than that is not worth a thread
+    inline static constexpr std::size_t PARALLEL_MIN = 64 * 1024;
+
+    // With t_threads 0 (by default), one per hardware thread, like ShardedBitsetAccumulator
+    inline explicit HammingIndex(const BitsetPool& t_pool, const std::size_t t_threads = 0);
+
+    // t_substrings 0 removes it. Each substring has 64 bits as maximum, so there are at least width() / 64
+    // If it throws, the index is left without multi index
+    inline void buildMultiIndex(const std::size_t t_substrings);
+    inline std::size_t substrings() const noexcept {return m_substrings.size();}
+
+    // The t_k nearest bitsets, from the nearest (with the same distance, the lowest index first)
+    inline std::vector<Neighbour> knn(const ConstBitsetView& t_query, const std::size_t t_k) const;
+    inline std::vector<Neighbour> knn(const RuntimeBitset& t_query, const std::size_t t_k) const;
+    // All the bitsets at distance t_radius or less, in the same order
+    inline std::vector<Neighbour> radius_search(const ConstBitsetView& t_query, const std::size_t t_radius) const;
+    inline std::vector<Neighbour> radius_search(const RuntimeBitset& t_query, const std::size_t t_radius) const;
+
+    inline static std::size_t distance(const ConstBitsetView& t_1, const ConstBitsetView& t_2);
+
+  private:
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+
+    // The bitsets sorted by the value of the bits [start, start + length)
+    struct Substring {
+      std::size_t start;
+      std::size_t length;
+      std::vector<std::size_t> keys; // sorted
+      std::vector<std::size_t> indexes; // the bitset of each key
+    };
+
+    // PRIVATE METHODS
+    inline std::vector<Neighbour> knnScan(const std::size_t* t_query, const std::size_t t_k) const;
+    inline std::vector<Neighbour> knnMultiIndex(const std::size_t* t_query, const std::size_t t_k) const;
+    inline std::vector<Neighbour> radiusScan(const std::size_t* t_query, const std::size_t t_radius) const;
+    inline std::vector<Neighbour> radiusMultiIndex(const std::size_t* t_query, const std::size_t t_radius) const;
+    // Calls t_function(index, distance) for each bitset of [t_first, t_last), with the blocks known at compile time
+    //   for the usual sizes (1, 2, 4 and 8 blocks), so the loop of the distance is unrolled
+    template<typename Function>
+    inline void scan(const std::size_t* t_query, const std::size_t t_first, const std::size_t t_last, Function t_function) const;
+    template<std::size_t BLOCKS, typename Function>
+    inline void scanBlocks(const std::size_t* t_query, const std::size_t t_first, const std::size_t t_last, Function& t_function) const;
+    // Calls t_function(first, last) for some ranges of [0, t_count) in several threads (t_count / PARALLEL_MIN as maximum)
+    template<typename Function>
+    inline void parallelRanges(const std::size_t t_count, Function t_function) const;
+    // Calls t_function(i) for each i of [0, t_workers), the 0 in this thread and the rest in their own threads
+    // An exception can´t leave a thread (it would terminate), so the first one is thrown here when all of them end
+    template<typename Function>
+    inline static void runWorkers(const std::size_t t_workers, Function t_function);
+    // Calls t_function(index) for each bitset with the substring at distance t_distance of t_key
+    //   (only flipping the bits below t_below)
+    template<typename Function>
+    inline void probe
+    (const Substring& t_substring, const std::size_t t_key, const std::size_t t_distance, const std::size_t t_below, Function& t_function) const;
+    // Number of keys at distance t_distance of a substring of t_length bits (C(t_length, t_distance)), limited to t_limit
+    inline static std::size_t probes(const std::size_t t_length, const std::size_t t_distance, const std::size_t t_limit) noexcept;
+    inline static std::size_t extract(const std::size_t* t_blocks, const std::size_t t_start, const std::size_t t_length) noexcept;
+    // Popcount of t_1 ^ t_2, BLOCKS 0 is t_blocks blocks
+    template<std::size_t BLOCKS>
+    inline static std::size_t xorCount(const std::size_t* t_1, const std::size_t* t_2, const std::size_t t_blocks) noexcept;
+    inline std::size_t distanceTo(const std::size_t* t_query, const std::size_t t_index) const noexcept;
+    // The bounded max heap of knn, the farthest is the first
+    inline static void pushNeighbour(std::vector<Neighbour>& t_heap, const std::size_t t_k, const Neighbour t_neighbour);
+    inline static bool isCloser(const Neighbour& t_1, const Neighbour& t_2) noexcept;
+    inline std::vector<std::size_t> queryBlocks(const RuntimeBitset& t_query) const;
+    inline void checkQuery(const std::size_t t_size) const;
+
+    // Attributes
+    const BitsetPool* m_pool;
+    std::size_t m_threads;
+    std::vector<Substring> m_substrings;
+    std::size_t m_indexed = 0; // bitsets in the substrings
+};
+
+} // namespace RunBitset
+
+
+RunBitset::HammingIndex::HammingIndex(const BitsetPool& t_pool, const std::size_t t_threads)
+: m_pool(&t_pool), m_threads((t_threads == 0) ? std::max<std::size_t>(std::thread::hardware_concurrency(), 1) : t_threads) {}
+
+// The lengths of the substrings differ in 1 bit as maximum
+void RunBitset::HammingIndex::buildMultiIndex(const std::size_t t_substrings) {
+  m_substrings.clear();
+  m_indexed = 0;
+  if (t_substrings == 0) return;
+  const std::size_t width = m_pool->width();
+  const std::size_t count = std::clamp<std::size_t>(t_substrings, (width + BLOCK_SIZE - 1) / BLOCK_SIZE, width);
+  m_indexed = m_pool->size();
+  m_substrings.resize(count);
+  for (std::size_t s = 0, start = 0; s < count; ++s) {
+    m_substrings[s].start = start;
+    m_substrings[s].length = width / count + (s < width % count ? 1 : 0);
+    start += m_substrings[s].length;
+  }
+  std::atomic<std::size_t> next{0};
+  auto build = [&](std::size_t) {
+    for (std::size_t s = next.fetch_add(1); s < count; s = next.fetch_add(1)) {
+      Substring& substring = m_substrings[s];
+      std::vector<std::pair<std::size_t, std::size_t>> entries(m_indexed);
+      for (std::size_t i = 0; i < m_indexed; ++i) {
+        entries[i] = {extract(m_pool->data() + i * m_pool->blocks(), substring.start, substring.length), i};
+      }
+      std::sort(entries.begin(), entries.end());
+      substring.keys.resize(m_indexed);
+      substring.indexes.resize(m_indexed);
+      for (std::size_t i = 0; i < m_indexed; ++i) {
+        substring.keys[i] = entries[i].first;
+        substring.indexes[i] = entries[i].second;
+      }
+    }
+  };
+  try {
+    runWorkers(std::min(m_threads, count), build);
+  }
+  catch (...) { // some substrings are not sorted
+    m_substrings.clear();
+    m_indexed = 0;
+    throw;
+  }
+}
+
+std::vector<RunBitset::HammingIndex::Neighbour> RunBitset::HammingIndex::knn(const ConstBitsetView& t_query, const std::size_t t_k) const {
+  checkQuery(t_query.size());
+  if (t_k == 0 || m_pool->empty()) return {};
+  return m_substrings.empty() ? knnScan(t_query.data(), t_k) : knnMultiIndex(t_query.data(), t_k);
+}
+
+std::vector<RunBitset::HammingIndex::Neighbour> RunBitset::HammingIndex::knn(const RuntimeBitset& t_query, const std::size_t t_k) const {
+  const std::vector<std::size_t> blocks = queryBlocks(t_query);
+  return knn(ConstBitsetView(blocks.data(), t_query.size()), t_k);
+}
+
+std::vector<RunBitset::HammingIndex::Neighbour> RunBitset::HammingIndex::radius_search
+(const ConstBitsetView& t_query, const std::size_t t_radius) const {
+  checkQuery(t_query.size());
+  if (m_pool->empty()) return {};
+  return m_substrings.empty() ? radiusScan(t_query.data(), t_radius) : radiusMultiIndex(t_query.data(), t_radius);
+}
+
+std::vector<RunBitset::HammingIndex::Neighbour> RunBitset::HammingIndex::radius_search
+(const RuntimeBitset& t_query, const std::size_t t_radius) const {
+  const std::vector<std::size_t> blocks = queryBlocks(t_query);
+  return radius_search(ConstBitsetView(blocks.data(), t_query.size()), t_radius);
+}
+
+std::size_t RunBitset::HammingIndex::distance(const ConstBitsetView& t_1, const ConstBitsetView& t_2) {
+  if (t_1.size() != t_2.size()) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+  return xorCount<0>(t_1.data(), t_2.data(), t_1.blocks());
+}
+
+// Each thread keeps its own heap, they are merged at the end
+std::vector<RunBitset::HammingIndex::Neighbour> RunBitset::HammingIndex::knnScan(const std::size_t* t_query, const std::size_t t_k) const {
+  std::vector<std::vector<Neighbour>> heaps(m_threads);
+  std::atomic<std::size_t> nextHeap{0};
+  parallelRanges(m_pool->size(), [&](const std::size_t t_first, const std::size_t t_last) {
+    std::vector<Neighbour>& heap = heaps[nextHeap.fetch_add(1)];
+    scan(t_query, t_first, t_last, [&](const std::size_t t_index, const std::size_t t_distance) {
+      pushNeighbour(heap, t_k, {t_index, t_distance});
+    });
+  });
+  std::vector<Neighbour> toReturn;
+  for (const std::vector<Neighbour>& heap : heaps) {
+    toReturn.insert(toReturn.end(), heap.begin(), heap.end());
+  }
+  std::sort(toReturn.begin(), toReturn.end(), isCloser);
+  if (toReturn.size() > t_k) toReturn.resize(t_k);
+  return toReturn;
+}
+
+// The radius of the substrings grows one by one. After the radius r, all the bitsets at distance
+//   m * (r + 1) - 1 or less have been checked, so it stops when the k found are nearer than that
+std::vector<RunBitset::HammingIndex::Neighbour> RunBitset::HammingIndex::knnMultiIndex(const std::size_t* t_query, const std::size_t t_k) const {
+  std::vector<Neighbour> heap;
+  for (std::size_t i = m_indexed; i < m_pool->size(); ++i) { // added after the index
+    pushNeighbour(heap, t_k, {i, distanceTo(t_query, i)});
+  }
+  RuntimeBitset checked(std::max<std::size_t>(m_indexed, 1));
+  auto check = [&](const std::size_t t_index) {
+    if (checked.test(t_index)) return;
+    checked.set(t_index);
+    pushNeighbour(heap, t_k, {t_index, distanceTo(t_query, t_index)});
+  };
+  const std::size_t count = m_substrings.size();
+  const std::size_t wanted = std::min(t_k, m_pool->size());
+  for (std::size_t radius = 0; radius <= m_substrings[0].length; ++radius) {
+    std::size_t total = 0;
+    for (const Substring& substring : m_substrings) {
+      total += probes(substring.length, radius, m_indexed);
+    }
+    if (total >= m_indexed) { // more keys than bitsets, the scan is faster
+      scan(t_query, 0, m_indexed, [&](const std::size_t t_index, const std::size_t t_distance) {
+        if (!checked.test(t_index)) pushNeighbour(heap, t_k, {t_index, t_distance});
+      });
+      break;
+    }
+    for (const Substring& substring : m_substrings) {
+      probe(substring, extract(t_query, substring.start, substring.length), radius, substring.length, check);
+    }
+    if (heap.size() == wanted && heap.front().distance < count * (radius + 1)) break;
+  }
+  std::sort(heap.begin(), heap.end(), isCloser);
+  return heap;
+}
+
+std::vector<RunBitset::HammingIndex::Neighbour> RunBitset::HammingIndex::radiusScan(const std::size_t* t_query, const std::size_t t_radius) const {
+  std::vector<std::vector<Neighbour>> found(m_threads);
+  std::atomic<std::size_t> nextFound{0};
+  parallelRanges(m_pool->size(), [&](const std::size_t t_first, const std::size_t t_last) {
+    std::vector<Neighbour>& neighbours = found[nextFound.fetch_add(1)];
+    scan(t_query, t_first, t_last, [&](const std::size_t t_index, const std::size_t t_distance) {
+      if (t_distance <= t_radius) neighbours.push_back({t_index, t_distance});
+    });
+  });
+  std::vector<Neighbour> toReturn;
+  for (const std::vector<Neighbour>& neighbours : found) {
+    toReturn.insert(toReturn.end(), neighbours.begin(), neighbours.end());
+  }
+  std::sort(toReturn.begin(), toReturn.end(), isCloser);
+  return toReturn;
+}
+
+// A bitset at distance t_radius has a substring at distance t_radius / m or less
+std::vector<RunBitset::HammingIndex::Neighbour> RunBitset::HammingIndex::radiusMultiIndex(const std::size_t* t_query, const std::size_t t_radius) const {
+  const std::size_t radius = t_radius / m_substrings.size();
+  std::size_t total = 0;
+  for (const Substring& substring : m_substrings) {
+    for (std::size_t d = 0; d <= std::min(radius, substring.length); ++d) {
+      total += probes(substring.length, d, m_indexed);
+    }
+  }
+  if (total >= m_indexed) return radiusScan(t_query, t_radius);
+  std::vector<Neighbour> toReturn;
+  for (std::size_t i = m_indexed; i < m_pool->size(); ++i) { // added after the index
+    const std::size_t current = distanceTo(t_query, i);
+    if (current <= t_radius) toReturn.push_back({i, current});
+  }
+  RuntimeBitset checked(std::max<std::size_t>(m_indexed, 1));
+  auto check = [&](const std::size_t t_index) {
+    if (checked.test(t_index)) return;
+    checked.set(t_index);
+    const std::size_t current = distanceTo(t_query, t_index);
+    if (current <= t_radius) toReturn.push_back({t_index, current});
+  };
+  for (const Substring& substring : m_substrings) {
+    const std::size_t key = extract(t_query, substring.start, substring.length);
+    for (std::size_t d = 0; d <= std::min(radius, substring.length); ++d) {
+      probe(substring, key, d, substring.length, check);
+    }
+  }
+  std::sort(toReturn.begin(), toReturn.end(), isCloser);
+  return toReturn;
+}
+
+template<typename Function>
+void RunBitset::HammingIndex::scan
+(const std::size_t* t_query, const std::size_t t_first, const std::size_t t_last, Function t_function) const {
+  switch (m_pool->blocks()) {
+    case 1: scanBlocks<1>(t_query, t_first, t_last, t_function); break;
+    case 2: scanBlocks<2>(t_query, t_first, t_last, t_function); break;
+    case 4: scanBlocks<4>(t_query, t_first, t_last, t_function); break;
+    case 8: scanBlocks<8>(t_query, t_first, t_last, t_function); break;
+    default: scanBlocks<0>(t_query, t_first, t_last, t_function); break;
+  }
+}
+
+// BLOCKS 0 is any number of blocks
+template<std::size_t BLOCKS, typename Function>
+void RunBitset::HammingIndex::scanBlocks
+(const std::size_t* t_query, const std::size_t t_first, const std::size_t t_last, Function& t_function) const {
+  const std::size_t blocks = (BLOCKS == 0) ? m_pool->blocks() : BLOCKS;
+  const std::size_t* current = m_pool->data() + t_first * blocks;
+  for (std::size_t i = t_first; i < t_last; ++i, current += blocks) {
+    t_function(i, xorCount<BLOCKS>(current, t_query, blocks));
+  }
+}
+
+template<typename Function>
+void RunBitset::HammingIndex::parallelRanges(const std::size_t t_count, Function t_function) const {
+  const std::size_t threads = std::clamp<std::size_t>(t_count / PARALLEL_MIN, 1, m_threads);
+  runWorkers(threads, [&](const std::size_t t_worker) {
+    t_function(t_count * t_worker / threads, t_count * (t_worker + 1) / threads);
+  });
+}
+
+template<typename Function>
+void RunBitset::HammingIndex::runWorkers(const std::size_t t_workers, Function t_function) {
+  std::vector<std::exception_ptr> errors(t_workers);
+  auto run = [&](const std::size_t t_worker) {
+    try {
+      t_function(t_worker);
+    }
+    catch (...) {
+      errors[t_worker] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> workers;
+  workers.reserve(t_workers);
+  for (std::size_t i = 1; i < t_workers; ++i) {
+    try {
+      workers.emplace_back(run, i);
+    }
+    catch (const std::system_error&) { // no more threads, this one does its part
+      run(i);
+    }
+  }
+  run(0);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  for (const std::exception_ptr& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+}
+
+// The keys at distance t_distance are the key with t_distance of its bits below t_below flipped
+// The highest bit flipped goes first, so each key is visited once
+template<typename Function>
+void RunBitset::HammingIndex::probe
+(const Substring& t_substring, const std::size_t t_key, const std::size_t t_distance, const std::size_t t_below, Function& t_function) const {
+  if (t_distance == 0) {
+    const auto range = std::equal_range(t_substring.keys.begin(), t_substring.keys.end(), t_key);
+    for (auto i = range.first; i != range.second; ++i) {
+      t_function(t_substring.indexes[i - t_substring.keys.begin()]);
+    }
+    return;
+  }
+  for (std::size_t bit = t_distance - 1; bit < t_below; ++bit) {
+    probe(t_substring, t_key ^ (static_cast<std::size_t>(1) << bit), t_distance - 1, bit, t_function);
+  }
+}
+
+std::size_t RunBitset::HammingIndex::probes(const std::size_t t_length, const std::size_t t_distance, const std::size_t t_limit) noexcept {
+  if (t_distance > t_length) return 0;
+  std::size_t toReturn = 1;
+  for (std::size_t i = 0; i < t_distance; ++i) {
+    toReturn = toReturn * (t_length - i) / (i + 1); // always exact
+    if (toReturn >= t_limit) return t_limit;
+  }
+  return toReturn;
+}
+
+std::size_t RunBitset::HammingIndex::extract(const std::size_t* t_blocks, const std::size_t t_start, const std::size_t t_length) noexcept {
+  const std::size_t block = t_start / BLOCK_SIZE;
+  const std::size_t offset = t_start % BLOCK_SIZE;
+  std::size_t value = t_blocks[block] >> offset;
+  if (offset + t_length > BLOCK_SIZE) value |= t_blocks[block + 1] << (BLOCK_SIZE - offset);
+  return (t_length == BLOCK_SIZE) ? value : value & ((static_cast<std::size_t>(1) << t_length) - 1);
+}
+
+std::size_t RunBitset::HammingIndex::distanceTo(const std::size_t* t_query, const std::size_t t_index) const noexcept {
+  return xorCount<0>(m_pool->data() + t_index * m_pool->blocks(), t_query, m_pool->blocks());
+}
+
+// The vectors only for the whole groups of blocks, the rest one by one
+template<std::size_t BLOCKS>
+std::size_t RunBitset::HammingIndex::xorCount
+(const std::size_t* t_1, const std::size_t* t_2, [[maybe_unused]] const std::size_t t_blocks) noexcept {
+  const std::size_t blocks = (BLOCKS == 0) ? t_blocks : BLOCKS;
+  std::size_t toReturn = 0;
+  std::size_t j = 0;
+#if defined(RUNBITSET_AVX512_POPCOUNT)
+  if (blocks >= 8) {
+    __m512i counts = _mm512_setzero_si512();
+    for (; j + 8 <= blocks; j += 8) {
+      const __m512i difference = _mm512_xor_si512(_mm512_loadu_si512(t_1 + j), _mm512_loadu_si512(t_2 + j));
+      counts = _mm512_add_epi64(counts, _mm512_popcnt_epi64(difference));
+    }
+    // Not _mm512_reduce_add_epi64, gcc 12 warns about its undefined registers
+    alignas(64) std::uint64_t lanes[8];
+    _mm512_store_si512(lanes, counts);
+    for (const std::uint64_t lane : lanes) {
+      toReturn += lane;
+    }
+  }
+#if defined(__AVX512VL__)
+  if (j + 4 <= blocks) { // 256 bits, the usual width of a descriptor
+    const __m256i difference = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_1 + j)), 
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_2 + j)));
+    const __m256i counts = _mm256_popcnt_epi64(difference);
+    const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(counts), _mm256_extracti128_si256(counts, 1));
+    toReturn += static_cast<std::size_t>(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+    j += 4;
+  }
+#endif
+#endif
+  for (; j < blocks; ++j) {
+    toReturn += std::popcount(t_1[j] ^ t_2[j]);
+  }
+  return toReturn;
+}
+
+void RunBitset::HammingIndex::pushNeighbour(std::vector<Neighbour>& t_heap, const std::size_t t_k, const Neighbour t_neighbour) {
+  if (t_heap.size() < t_k) {
+    t_heap.push_back(t_neighbour);
+    std::push_heap(t_heap.begin(), t_heap.end(), isCloser);
+  }
+  else if (isCloser(t_neighbour, t_heap.front())) {
+    std::pop_heap(t_heap.begin(), t_heap.end(), isCloser);
+    t_heap.back() = t_neighbour;
+    std::push_heap(t_heap.begin(), t_heap.end(), isCloser);
+  }
+}
+
+bool RunBitset::HammingIndex::isCloser(const Neighbour& t_1, const Neighbour& t_2) noexcept {
+  return t_1.distance < t_2.distance || (t_1.distance == t_2.distance && t_1.index < t_2.index);
+}
+
+std::vector<std::size_t> RunBitset::HammingIndex::queryBlocks(const RuntimeBitset& t_query) const {
+  checkQuery(t_query.size());
+  std::vector<std::size_t> toReturn(t_query.blocks());
+  for (std::size_t i = 0; i < toReturn.size(); ++i) {
+    toReturn[i] = t_query.getBlock(i);
+  }
+  return toReturn;
+}
+
+void RunBitset::HammingIndex::checkQuery(const std::size_t t_size) const {
+  if (t_size != m_pool->width()) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+}
@@ -0,0 +1,308 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, interface of the classes IdAllocator and ConcurrentIdAllocator,
+ *   allocators of ids (or slots) in [0, size) with a bitmap and summaries of the full blocks
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+
+#include <cstddef>
+#include <vector>
+#include <atomic>
+#include <bit>
+
+namespace RunBitsetException {
+
+class RuntimeBitsetInvalidId : public RuntimeBitsetException {
+  public:
+    RuntimeBitsetInvalidId() : RuntimeBitsetException("The id is not allocated") {}
+};
+
+}
+
+namespace RunBitset {
+
+// The ids are the bits of a RuntimeBitset (1 is allocated), and each level above has one bit per block
+//   of the level below, 1 if that block is full. The last level has only one block
+// So the first free id is found going down from the last level, one block per level (log64(size) blocks)
+class IdAllocator {
+  public:
+    inline explicit IdAllocator(const std::size_t t_size);
+
+    // The lowest free id, size() if all are allocated
+    inline std::size_t allocate();
+    // The first id of the lowest t_count consecutive free ids, size() if there isn´t any
+    inline std::size_t allocate_range(const std::size_t t_count);
+    // RuntimeBitsetInvalidId if the id (or one of the range) is not allocated
+    inline void free(const std::size_t t_id);
+    inline void free_range(const std::size_t t_first, const std::size_t t_count);
+
+    inline bool isAllocated(const std::size_t t_id) const;
+    inline std::size_t size() const noexcept {return m_levels[0].size();}
+    inline std::size_t allocated() const noexcept {return m_allocated;}
+    inline std::size_t available() const noexcept {return size() - m_allocated;}
+    inline std::size_t levels() const noexcept {return m_levels.size();}
+    // The bitmap of the ids, 1 is allocated
+    inline const RuntimeBitset& usedIds() const noexcept {return m_levels[0];}
+
+  private:
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    inline static constexpr std::size_t ALL_BITS_ONE = ~static_cast<std::size_t>(0);
+
+    // PRIVATE METHODS
+    // The first 0 of the level starting in t_position, the size of the level if there isn´t any
+    // The blocks that are full are skipped with the level above
+    inline std::size_t findFree(const std::size_t t_level, const std::size_t t_position) const;
+    // The first allocated id in [t_first, t_last), t_last if there isn´t any
+    inline std::size_t findUsed(const std::size_t t_first, const std::size_t t_last) const;
+    // The block t_block of the ids changed, update the levels above
+    inline void update(std::size_t t_block);
+    // Bits of the block that count to be full
+    inline std::size_t fullMask(const std::size_t t_level, const std::size_t t_block) const noexcept;
+    inline void checkRange(const std::size_t t_first, const std::size_t t_count) const;
+
+    // Attributes
+    std::vector<RuntimeBitset> m_levels; // the ids first
+    std::size_t m_allocated = 0;
+};
+
+// Same summaries, but every block is modified with atomics, so several threads can allocate and free
+// An id is taken with fetch_or, and if another thread took it first the search starts again
+// The summaries are only hints: a block marked as full is checked again after marking it,
+//   and a block that is full but not marked is marked by the first thread that finds it
+class ConcurrentIdAllocator {
+  public:
+    inline explicit ConcurrentIdAllocator(const std::size_t t_size);
+    ConcurrentIdAllocator(const ConcurrentIdAllocator&) = delete;
+    ConcurrentIdAllocator& operator=(const ConcurrentIdAllocator&) = delete;
+
+    // A free id (usually the lowest), size() if all are allocated
+    inline std::size_t allocate();
+    // RuntimeBitsetInvalidId if the id is not allocated
+    inline void free(const std::size_t t_id);
+
+    inline bool isAllocated(const std::size_t t_id) const;
+    inline std::size_t size() const noexcept {return m_size;}
+    inline std::size_t allocated() const noexcept {return m_allocated.load(std::memory_order_relaxed);}
+
+  private:
+    static_assert(std::atomic_ref<std::size_t>::is_always_lock_free, "the blocks must be lock free atomics");
+
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    inline static constexpr std::size_t ALL_BITS_ONE = ~static_cast<std::size_t>(0);
+
+    // PRIVATE METHODS
+    inline std::atomic_ref<std::size_t> word(const std::size_t t_level, const std::size_t t_block) const noexcept;
+    // The block t_block of t_level is full, mark it in the levels above
+    inline void markFull(std::size_t t_level, std::size_t t_block) const noexcept;
+    // The block t_block of t_level is not full anymore, unmark it in the levels above
+    inline void markNotFull(std::size_t t_level, std::size_t t_block) const noexcept;
+
+    // Attributes
+    // The ids first. The bits after the size of each level are 1, so a full block is always ALL_BITS_ONE
+    mutable std::vector<std::vector<std::size_t>> m_levels;
+    std::size_t m_size = 0;
+    std::atomic<std::size_t> m_allocated{0};
+};
+
+} // namespace RunBitset
+
+
+// ID ALLOCATOR
+RunBitset::IdAllocator::IdAllocator(const std::size_t t_size) {
+  m_levels.emplace_back(t_size); // RuntimeBitsetInvalidSize with 0
+  while (m_levels.back().blocks() > 1) {
+    m_levels.emplace_back(m_levels.back().blocks());
+  }
+}
+
+std::size_t RunBitset::IdAllocator::allocate() {
+  const std::size_t id = findFree(0, 0);
+  if (id == size()) return id;
+  m_levels[0].set(id);
+  update(id / BLOCK_SIZE);
+  ++m_allocated;
+  return id;
+}
+
+// Each run that is too short ends in an allocated id, the next one starts in the next free id after it
+std::size_t RunBitset::IdAllocator::allocate_range(const std::size_t t_count) {
+  if (t_count == 0 || t_count > available()) return size();
+  std::size_t first = findFree(0, 0);
+  while (first <= size() - t_count) {
+    const std::size_t used = findUsed(first, first + t_count);
+    if (used == first + t_count) break;
+    first = findFree(0, used);
+  }
+  if (first > size() - t_count) return size();
+  const std::size_t last = first + t_count - 1;
+  for (std::size_t block = first / BLOCK_SIZE; block <= last / BLOCK_SIZE; ++block) {
+    std::size_t mask = ALL_BITS_ONE;
+    if (block == first / BLOCK_SIZE) mask &= ALL_BITS_ONE << (first % BLOCK_SIZE);
+    if (block == last / BLOCK_SIZE) mask &= ALL_BITS_ONE >> (BLOCK_SIZE - 1 - last % BLOCK_SIZE);
+    m_levels[0].setBlock(block, m_levels[0].getBlock(block) | mask);
+    update(block);
+  }
+  m_allocated += t_count;
+  return first;
+}
+
+void RunBitset::IdAllocator::free(const std::size_t t_id) {
+  if (!isAllocated(t_id)) throw(RunBitsetException::RuntimeBitsetInvalidId());
+  m_levels[0].reset(t_id);
+  update(t_id / BLOCK_SIZE);
+  --m_allocated;
+}
+
+void RunBitset::IdAllocator::free_range(const std::size_t t_first, const std::size_t t_count) {
+  checkRange(t_first, t_count);
+  if (t_count == 0) return;
+  if (findFree(0, t_first) < t_first + t_count) throw(RunBitsetException::RuntimeBitsetInvalidId());
+  const std::size_t last = t_first + t_count - 1;
+  for (std::size_t block = t_first / BLOCK_SIZE; block <= last / BLOCK_SIZE; ++block) {
+    std::size_t mask = ALL_BITS_ONE;
+    if (block == t_first / BLOCK_SIZE) mask &= ALL_BITS_ONE << (t_first % BLOCK_SIZE);
+    if (block == last / BLOCK_SIZE) mask &= ALL_BITS_ONE >> (BLOCK_SIZE - 1 - last % BLOCK_SIZE);
+    m_levels[0].setBlock(block, m_levels[0].getBlock(block) & ~mask);
+    update(block);
+  }
+  m_allocated -= t_count;
+}
+
+bool RunBitset::IdAllocator::isAllocated(const std::size_t t_id) const {
+  return m_levels[0].test(t_id); // RuntimeBitsetOutOfRange
+}
+
+std::size_t RunBitset::IdAllocator::findFree(const std::size_t t_level, const std::size_t t_position) const {
+  const RuntimeBitset& level = m_levels[t_level];
+  if (t_position >= level.size()) return level.size();
+  const std::size_t block = t_position / BLOCK_SIZE;
+  // Rest of the block of t_position
+  const std::size_t free = ~level.getBlock(block) & fullMask(t_level, block) & (ALL_BITS_ONE << (t_position % BLOCK_SIZE));
+  if (free != 0) return block * BLOCK_SIZE + std::countr_zero(free);
+  if (t_level + 1 == m_levels.size()) return level.size(); // only one block
+  // The next block that is not full, it has a 0 for sure
+  const std::size_t next = findFree(t_level + 1, block + 1);
+  if (next == m_levels[t_level + 1].size()) return level.size();
+  return next * BLOCK_SIZE + std::countr_zero(~level.getBlock(next) & fullMask(t_level, next));
+}
+
+std::size_t RunBitset::IdAllocator::findUsed(const std::size_t t_first, const std::size_t t_last) const {
+  for (std::size_t block = t_first / BLOCK_SIZE; block * BLOCK_SIZE < t_last; ++block) {
+    std::size_t used = m_levels[0].getBlock(block);
+    if (block == t_first / BLOCK_SIZE) used &= ALL_BITS_ONE << (t_first % BLOCK_SIZE);
+    if (used != 0) return std::min(block * BLOCK_SIZE + std::countr_zero(used), t_last);
+  }
+  return t_last;
+}
+
+// It stops in the first level whose bit doesn´t change
+void RunBitset::IdAllocator::update(std::size_t t_block) {
+  for (std::size_t level = 0; level + 1 < m_levels.size(); ++level) {
+    const bool full = m_levels[level].getBlock(t_block) == fullMask(level, t_block);
+    if (m_levels[level + 1].test(t_block) == full) return;
+    if (full) m_levels[level + 1].set(t_block);
+    else m_levels[level + 1].reset(t_block);
+    t_block /= BLOCK_SIZE;
+  }
+}
+
+std::size_t RunBitset::IdAllocator::fullMask(const std::size_t t_level, const std::size_t t_block) const noexcept {
+  const RuntimeBitset& level = m_levels[t_level];
+  if (t_block != level.blocks() - 1) return ALL_BITS_ONE;
+  return ALL_BITS_ONE >> (level.blocks() * BLOCK_SIZE - level.size());
+}
+
+void RunBitset::IdAllocator::checkRange(const std::size_t t_first, const std::size_t t_count) const {
+  if (t_first >= size() || t_count > size() - t_first) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+}
+
+// CONCURRENT ID ALLOCATOR
+RunBitset::ConcurrentIdAllocator::ConcurrentIdAllocator(const std::size_t t_size) : m_size(t_size) {
+  // Bitsets of size 0 breaks the implementation
+  if (t_size == 0) throw (RunBitsetException::RuntimeBitsetInvalidSize());
+  std::size_t bits = t_size;
+  do {
+    const std::size_t blocks = (bits + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    m_levels.emplace_back(blocks, 0);
+    // The bits after the size are never free
+    if (bits % BLOCK_SIZE != 0) m_levels.back().back() = ALL_BITS_ONE << (bits % BLOCK_SIZE);
+    bits = blocks;
+  } while (bits > 1);
+}
+
+std::size_t RunBitset::ConcurrentIdAllocator::allocate() {
+  const std::size_t top = m_levels.size() - 1;
+  while (true) {
+    std::size_t value = word(top, 0).load(std::memory_order_acquire);
+    if (value == ALL_BITS_ONE) return m_size; // all allocated
+    std::size_t level = top;
+    std::size_t block = 0;
+    // Down to the ids, following the blocks that are not full
+    while (level > 0 && value != ALL_BITS_ONE) {
+      block = block * BLOCK_SIZE + std::countr_zero(~value);
+      --level;
+      value = word(level, block).load(std::memory_order_acquire);
+    }
+    if (value == ALL_BITS_ONE) { // the summary was old, fix it and start again
+      markFull(level, block);
+      continue;
+    }
+    const std::size_t bit = static_cast<std::size_t>(1) << std::countr_zero(~value);
+    const std::size_t old = word(0, block).fetch_or(bit, std::memory_order_acq_rel);
+    if ((old & bit) != 0) continue; // another thread took it first
+    if ((old | bit) == ALL_BITS_ONE) markFull(0, block);
+    m_allocated.fetch_add(1, std::memory_order_relaxed);
+    return block * BLOCK_SIZE + std::countr_zero(bit);
+  }
+}
+
+void RunBitset::ConcurrentIdAllocator::free(const std::size_t t_id) {
+  if (t_id >= m_size) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  const std::size_t bit = static_cast<std::size_t>(1) << (t_id % BLOCK_SIZE);
+  const std::size_t old = word(0, t_id / BLOCK_SIZE).fetch_and(~bit, std::memory_order_acq_rel);
+  if ((old & bit) == 0) throw(RunBitsetException::RuntimeBitsetInvalidId());
+  m_allocated.fetch_sub(1, std::memory_order_relaxed);
+  if (old == ALL_BITS_ONE) markNotFull(0, t_id / BLOCK_SIZE);
+}
+
+bool RunBitset::ConcurrentIdAllocator::isAllocated(const std::size_t t_id) const {
+  if (t_id >= m_size) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  return (word(0, t_id / BLOCK_SIZE).load(std::memory_order_acquire) >> (t_id % BLOCK_SIZE)) & 1;
+}
+
+std::atomic_ref<std::size_t> RunBitset::ConcurrentIdAllocator::word(const std::size_t t_level, const std::size_t t_block) const noexcept {
+  return std::atomic_ref<std::size_t>(m_levels[t_level][t_block]);
+}
+
+// A free between the block getting full and its mark would be lost, so the block is checked again after the mark
+//   (and the mark removed if it is not full). The thread of that free removes it too if it comes later
+void RunBitset::ConcurrentIdAllocator::markFull(std::size_t t_level, std::size_t t_block) const noexcept {
+  for (; t_level + 1 < m_levels.size(); ++t_level) {
+    const std::size_t bit = static_cast<std::size_t>(1) << (t_block % BLOCK_SIZE);
+    const std::size_t parent = t_block / BLOCK_SIZE;
+    const std::size_t old = word(t_level + 1, parent).fetch_or(bit, std::memory_order_acq_rel);
+    if (word(t_level, t_block).load(std::memory_order_acquire) != ALL_BITS_ONE) {
+      word(t_level + 1, parent).fetch_and(~bit, std::memory_order_acq_rel);
+      return;
+    }
+    if ((old | bit) != ALL_BITS_ONE) return;
+    t_block = parent;
+  }
+}
+
+void RunBitset::ConcurrentIdAllocator::markNotFull(std::size_t t_level, std::size_t t_block) const noexcept {
+  for (; t_level + 1 < m_levels.size(); ++t_level) {
+    const std::size_t bit = static_cast<std::size_t>(1) << (t_block % BLOCK_SIZE);
+    const std::size_t parent = t_block / BLOCK_SIZE;
+    const std::size_t old = word(t_level + 1, parent).fetch_and(~bit, std::memory_order_acq_rel);
+    if (old != ALL_BITS_ONE) return; // the parent was not full, the levels above are right
+    t_block = parent;
+  }
+}
@@ -0,0 +1,411 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, interface of the class PagedBitset, represents
+ *   a sparse bitset whose blocks are allocated by pages on the first write
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+
+#include <string>
+#include <cstddef>
+#include <vector>
+#include <bit>
+#include <algorithm>
+
+namespace RunBitset {
+
+// The read members, the single and bulk modifiers and &=, |=, ^= of RuntimeBitset (no Reference, views,
+//   shifts, binary operators, streams or block access), but the blocks are stored in pages of PAGE_BLOCKS blocks
+// A page that was never written is not allocated, and it is read as a page of 0
+// So the memory used is only the memory of the pages with active bits (plus the page table)
+class PagedBitset {
+  public:
+    // SPECIAL MEMBERS
+    inline PagedBitset(const std::size_t t_size);
+    inline PagedBitset(const RuntimeBitset& t_bitset);
+    inline PagedBitset(); // Default constructor
+    inline ~PagedBitset(); // Destructor
+    inline PagedBitset(const PagedBitset& t_PagedBitset); // Copy constructor
+    inline PagedBitset& operator=(const PagedBitset& t_PagedBitset); // Copy assignment
+    inline PagedBitset(PagedBitset&& t_PagedBitset) noexcept; // Move constructor
+    inline PagedBitset& operator=(PagedBitset&& t_PagedBitset) noexcept; // Move assignment
+
+    inline std::string to_string() const;
+    inline RuntimeBitset toRuntimeBitset() const;
+
+    // NORMAL MEMBERS
+    inline bool operator[](std::size_t t_position) const;
+    inline bool test(std::size_t t_position) const;
+
+    inline bool all() const noexcept;
+    inline bool any() const noexcept;
+    inline bool none() const noexcept;
+
+    inline std::size_t count() const noexcept;
+
+    // Find the first active bit starting in t_position, returns size() if there isn´t any
+    inline std::size_t find_first() const noexcept;
+    inline std::size_t find_next(const std::size_t t_position) const noexcept;
+
+    // Capacity
+    inline std::size_t size() const noexcept {return m_size;}
+    inline std::size_t pages() const noexcept {return m_pages.size();}
+    // Number of pages really allocated
+    inline std::size_t allocatedPages() const noexcept;
+
+    // Modifiers
+    inline PagedBitset& set();
+    inline PagedBitset& set(const std::size_t t_position);
+    inline PagedBitset& reset() noexcept;
+    inline PagedBitset& reset(const std::size_t t_position);
+    inline PagedBitset& flip();
+    inline PagedBitset& flip(const std::size_t t_position);
+
+    inline PagedBitset& operator&=(const PagedBitset& t_other);
+    inline PagedBitset& operator|=(const PagedBitset& t_other);
+    inline PagedBitset& operator^=(const PagedBitset& t_other);
+
+    // Free the pages that are all 0, returns the number of freed pages
+    inline std::size_t reclaim() noexcept;
+
+    // Number of blocks of each page (4 KB with blocks of 64 bits)
+    inline static constexpr std::size_t PAGE_BLOCKS = 512;
+
+  private:
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    inline static constexpr std::size_t ALL_BITS_ONE = ~static_cast<std::size_t>(0);
+    // Shared page returned for the pages not allocated
+    inline static constexpr std::size_t ZERO_PAGE[PAGE_BLOCKS] = {};
+
+    // PRIVATE METHODS
+    inline void build(const std::size_t t_size);
+    inline void destroy() noexcept;
+    inline std::size_t getMask(const std::size_t t_block) const noexcept;
+    // The page t_page, or ZERO_PAGE if it is not allocated
+    inline const std::size_t* getPage(const std::size_t t_page) const noexcept;
+    // The page t_page, allocated (with all 0) if it was not
+    inline std::size_t* getWritablePage(const std::size_t t_page);
+    inline std::size_t getBlock(const std::size_t t_block) const noexcept;
+    inline void freePage(const std::size_t t_page) noexcept;
+    // Free the page if all its blocks are 0, returns true if it has been freed
+    inline bool freePageIfEmpty(const std::size_t t_page) noexcept;
+    inline void checkPosition(const std::size_t t_position) const;
+    inline void checkSize(const PagedBitset& t_other) const;
+
+    // Attributes
+    std::vector<std::size_t*> m_pages; // nullptr is a page of 0, little endian
+    std::size_t m_size = 0;
+    std::size_t m_blocks = 0;
+    std::size_t m_lastMask = 0; // mask of the most significant block
+};
+
+} // namespace RunBitset
+
+
+RunBitset::PagedBitset::PagedBitset(const std::size_t t_size) {
+  build(t_size);
+}
+
+RunBitset::PagedBitset::PagedBitset(const RuntimeBitset& t_bitset) {
+  build(t_bitset.size());
+  // Only the blocks with active bits allocate their page
+  for (std::size_t i = 0; i < t_bitset.blocks(); ++i) {
+    const std::size_t block = t_bitset.getBlock(i);
+    if (block != 0) getWritablePage(i / PAGE_BLOCKS)[i % PAGE_BLOCKS] = block;
+  }
+}
+
+RunBitset::PagedBitset::PagedBitset() {
+  build(BLOCK_SIZE);
+}
+
+RunBitset::PagedBitset::~PagedBitset() {
+  destroy();
+}
+
+RunBitset::PagedBitset::PagedBitset(const PagedBitset& t_PagedBitset) {
+  build(t_PagedBitset.m_size);
+  for (std::size_t i = 0; i < m_pages.size(); ++i) {
+    if (t_PagedBitset.m_pages[i] == nullptr) continue;
+    std::copy_n(t_PagedBitset.m_pages[i], PAGE_BLOCKS, getWritablePage(i));
+  }
+}
+
+RunBitset::PagedBitset& RunBitset::PagedBitset::operator=(const PagedBitset& t_PagedBitset) {
+  if (this == &t_PagedBitset) return *this;
+  PagedBitset aux(t_PagedBitset); // if the copy fails, this is not modified
+  *this = std::move(aux);
+  return *this;
+}
+
+RunBitset::PagedBitset::PagedBitset(PagedBitset&& t_PagedBitset) noexcept
+: m_pages(std::move(t_PagedBitset.m_pages)), m_size(t_PagedBitset.m_size),
+  m_blocks(t_PagedBitset.m_blocks), m_lastMask(t_PagedBitset.m_lastMask) {
+  t_PagedBitset.m_pages.clear();
+  t_PagedBitset.m_size = 0;
+  t_PagedBitset.m_blocks = 0;
+}
+
+RunBitset::PagedBitset& RunBitset::PagedBitset::operator=(PagedBitset&& t_PagedBitset) noexcept {
+  if (this == &t_PagedBitset) return *this;
+  destroy();
+  m_pages = std::move(t_PagedBitset.m_pages);
+  m_size = t_PagedBitset.m_size;
+  m_blocks = t_PagedBitset.m_blocks;
+  m_lastMask = t_PagedBitset.m_lastMask;
+  t_PagedBitset.m_pages.clear();
+  t_PagedBitset.m_size = 0;
+  t_PagedBitset.m_blocks = 0;
+  return *this;
+}
+
+std::string RunBitset::PagedBitset::to_string() const {
+  std::string toReturn(m_size, '0');
+  for (std::size_t i = find_first(); i < m_size; i = find_next(i + 1)) {
+    toReturn[m_size - 1 - i] = '1'; // the most significant bit is the first character
+  }
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::PagedBitset::toRuntimeBitset() const {
+  RuntimeBitset toReturn(m_size);
+  for (std::size_t p = 0; p < m_pages.size(); ++p) {
+    if (m_pages[p] == nullptr) continue;
+    const std::size_t last = std::min((p + 1) * PAGE_BLOCKS, m_blocks);
+    for (std::size_t i = p * PAGE_BLOCKS; i < last; ++i) {
+      toReturn.setBlock(i, getBlock(i));
+    }
+  }
+  return toReturn;
+}
+
+bool RunBitset::PagedBitset::operator[](std::size_t t_position) const {
+  return test(t_position);
+}
+
+bool RunBitset::PagedBitset::test(std::size_t t_position) const {
+  checkPosition(t_position);
+  return (getBlock(t_position / BLOCK_SIZE) >> (t_position % BLOCK_SIZE)) & 1;
+}
+
+bool RunBitset::PagedBitset::all() const noexcept {
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    // A page not allocated can´t be all 1
+    if (m_pages[i / PAGE_BLOCKS] == nullptr) return false;
+    if (getBlock(i) != getMask(i)) return false;
+  }
+  return true;
+}
+
+bool RunBitset::PagedBitset::any() const noexcept {
+  return find_first() != m_size;
+}
+
+bool RunBitset::PagedBitset::none() const noexcept {
+  return find_first() == m_size;
+}
+
+std::size_t RunBitset::PagedBitset::count() const noexcept {
+  std::size_t numberOfActive = 0;
+  for (std::size_t p = 0; p < m_pages.size(); ++p) {
+    if (m_pages[p] == nullptr) continue; // nothing to count in a page of 0
+    const std::size_t last = std::min((p + 1) * PAGE_BLOCKS, m_blocks);
+    for (std::size_t i = p * PAGE_BLOCKS; i < last; ++i) {
+      numberOfActive += std::popcount(getBlock(i));
+    }
+  }
+  return numberOfActive;
+}
+
+std::size_t RunBitset::PagedBitset::find_first() const noexcept {
+  return find_next(0);
+}
+
+std::size_t RunBitset::PagedBitset::find_next(const std::size_t t_position) const noexcept {
+  if (t_position >= m_size) return m_size;
+  std::size_t block = t_position / BLOCK_SIZE;
+  // Rest of the block of t_position
+  const std::size_t first = getBlock(block) & (ALL_BITS_ONE << (t_position % BLOCK_SIZE));
+  if (first != 0) return block * BLOCK_SIZE + std::countr_zero(first);
+  for (++block; block < m_blocks; ++block) {
+    if (m_pages[block / PAGE_BLOCKS] == nullptr) { // skip all the page
+      block = (block / PAGE_BLOCKS + 1) * PAGE_BLOCKS - 1;
+      continue;
+    }
+    const std::size_t value = getBlock(block);
+    if (value != 0) return block * BLOCK_SIZE + std::countr_zero(value);
+  }
+  return m_size;
+}
+
+std::size_t RunBitset::PagedBitset::allocatedPages() const noexcept {
+  return static_cast<std::size_t>(std::count_if(m_pages.begin(), m_pages.end(),
+    [](const std::size_t* t_page) {return t_page != nullptr;}));
+}
+
+RunBitset::PagedBitset& RunBitset::PagedBitset::set() {
+  for (std::size_t p = 0; p < m_pages.size(); ++p) {
+    std::fill_n(getWritablePage(p), PAGE_BLOCKS, ALL_BITS_ONE);
+  }
+  return *this;
+}
+
+RunBitset::PagedBitset& RunBitset::PagedBitset::set(const std::size_t t_position) {
+  checkPosition(t_position);
+  const std::size_t block = t_position / BLOCK_SIZE;
+  getWritablePage(block / PAGE_BLOCKS)[block % PAGE_BLOCKS] |= (static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE));
+  return *this;
+}
+
+RunBitset::PagedBitset& RunBitset::PagedBitset::reset() noexcept {
+  for (std::size_t p = 0; p < m_pages.size(); ++p) {
+    freePage(p);
+  }
+  return *this;
+}
+
+RunBitset::PagedBitset& RunBitset::PagedBitset::reset(const std::size_t t_position) {
+  checkPosition(t_position);
+  const std::size_t block = t_position / BLOCK_SIZE;
+  std::size_t* page = m_pages[block / PAGE_BLOCKS];
+  if (page == nullptr) return *this; // already 0, don´t allocate
+  page[block % PAGE_BLOCKS] &= ~(static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE));
+  // The page can only be empty now if this block is empty
+  if (getBlock(block) == 0) freePageIfEmpty(block / PAGE_BLOCKS);
+  return *this;
+}
+
+RunBitset::PagedBitset& RunBitset::PagedBitset::flip() {
+  for (std::size_t p = 0; p < m_pages.size(); ++p) {
+    std::size_t* page = getWritablePage(p);
+    for (std::size_t i = 0; i < PAGE_BLOCKS; ++i) {
+      page[i] = ~page[i];
+    }
+    freePageIfEmpty(p);
+  }
+  return *this;
+}
+
+RunBitset::PagedBitset& RunBitset::PagedBitset::flip(const std::size_t t_position) {
+  checkPosition(t_position);
+  const std::size_t block = t_position / BLOCK_SIZE;
+  getWritablePage(block / PAGE_BLOCKS)[block % PAGE_BLOCKS] ^= (static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE));
+  if (getBlock(block) == 0) freePageIfEmpty(block / PAGE_BLOCKS);
+  return *this;
+}
+
+// A & 0 is 0, the pages not allocated in t_other are freed
+RunBitset::PagedBitset& RunBitset::PagedBitset::operator&=(const PagedBitset& t_other) {
+  checkSize(t_other);
+  for (std::size_t p = 0; p < m_pages.size(); ++p) {
+    if (m_pages[p] == nullptr) continue;
+    if (t_other.m_pages[p] == nullptr) {
+      freePage(p);
+      continue;
+    }
+    for (std::size_t i = 0; i < PAGE_BLOCKS; ++i) {
+      m_pages[p][i] &= t_other.m_pages[p][i];
+    }
+    freePageIfEmpty(p);
+  }
+  return *this;
+}
+
+// A | 0 and A ^ 0 are A, only the pages allocated in t_other are visited
+RunBitset::PagedBitset& RunBitset::PagedBitset::operator|=(const PagedBitset& t_other) {
+  checkSize(t_other);
+  for (std::size_t p = 0; p < m_pages.size(); ++p) {
+    if (t_other.m_pages[p] == nullptr) continue;
+    std::size_t* page = getWritablePage(p);
+    for (std::size_t i = 0; i < PAGE_BLOCKS; ++i) {
+      page[i] |= t_other.m_pages[p][i];
+    }
+  }
+  return *this;
+}
+
+RunBitset::PagedBitset& RunBitset::PagedBitset::operator^=(const PagedBitset& t_other) {
+  checkSize(t_other);
+  for (std::size_t p = 0; p < m_pages.size(); ++p) {
+    if (t_other.m_pages[p] == nullptr) continue;
+    std::size_t* page = getWritablePage(p);
+    for (std::size_t i = 0; i < PAGE_BLOCKS; ++i) {
+      page[i] ^= t_other.m_pages[p][i];
+    }
+    freePageIfEmpty(p);
+  }
+  return *this;
+}
+
+std::size_t RunBitset::PagedBitset::reclaim() noexcept {
+  std::size_t freed = 0;
+  for (std::size_t p = 0; p < m_pages.size(); ++p) {
+    if (m_pages[p] != nullptr && freePageIfEmpty(p)) ++freed;
+  }
+  return freed;
+}
+
+void RunBitset::PagedBitset::build(const std::size_t t_size) {
+  // Bitsets of size 0 breaks the implementation
+  if (t_size == 0) throw (RunBitsetException::RuntimeBitsetInvalidSize());
+  m_size = t_size;
+  m_blocks = (t_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  m_lastMask = ALL_BITS_ONE >> (m_blocks * BLOCK_SIZE - t_size);
+  // Only the page table, the pages are allocated when they are written
+  m_pages.assign((m_blocks + PAGE_BLOCKS - 1) / PAGE_BLOCKS, nullptr);
+}
+
+void RunBitset::PagedBitset::destroy() noexcept {
+  for (std::size_t p = 0; p < m_pages.size(); ++p) {
+    freePage(p);
+  }
+  m_pages.clear();
+}
+
+std::size_t RunBitset::PagedBitset::getMask(const std::size_t t_block) const noexcept {
+  return (t_block == m_blocks - 1) ? m_lastMask : ALL_BITS_ONE;
+}
+
+const std::size_t* RunBitset::PagedBitset::getPage(const std::size_t t_page) const noexcept {
+  return (m_pages[t_page] == nullptr) ? ZERO_PAGE : m_pages[t_page];
+}
+
+std::size_t* RunBitset::PagedBitset::getWritablePage(const std::size_t t_page) {
+  if (m_pages[t_page] == nullptr) {
+    m_pages[t_page] = new std::size_t[PAGE_BLOCKS](); // all 0
+  }
+  return m_pages[t_page];
+}
+
+std::size_t RunBitset::PagedBitset::getBlock(const std::size_t t_block) const noexcept {
+  return getPage(t_block / PAGE_BLOCKS)[t_block % PAGE_BLOCKS] & getMask(t_block);
+}
+
+void RunBitset::PagedBitset::freePage(const std::size_t t_page) noexcept {
+  if (m_pages[t_page] != nullptr) { // Avoid double deletion
+    delete[] m_pages[t_page];
+    m_pages[t_page] = nullptr;
+  }
+}
+
+bool RunBitset::PagedBitset::freePageIfEmpty(const std::size_t t_page) noexcept {
+  const std::size_t last = std::min((t_page + 1) * PAGE_BLOCKS, m_blocks);
+  for (std::size_t i = t_page * PAGE_BLOCKS; i < last; ++i) {
+    if (getBlock(i) != 0) return false;
+  }
+  freePage(t_page);
+  return true;
+}
+
+void RunBitset::PagedBitset::checkPosition(const std::size_t t_position) const {
+  if (t_position >= m_size) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+}
+
+void RunBitset::PagedBitset::checkSize(const PagedBitset& t_other) const {
+  if (m_size != t_other.m_size) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+}
@@ -0,0 +1,323 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, interface of the class PersistentBitset, represents
+ *   an inmutable bitset whose modifications return a new version
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+
+#include <string>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <bit>
+#include <algorithm>
+
+namespace RunBitset {
+
+// The blocks are stored in chunks of CHUNK_BLOCKS blocks, the leaves of a tree of BRANCHES children
+// set(), reset() and flip() don´t modify the bitset, they return a new version that only copies
+//   the path from the root to the modified chunk, the rest of the tree is shared with the old one
+// A subtree of 0 is not allocated, so the memory grows with the modified chunks
+// The nodes are never modified after being built, so any version can be read from any thread
+//   without locks (the versions themselves are values, each thread must use its own copy)
+class PersistentBitset {
+  public:
+    // SPECIAL MEMBERS
+    inline PersistentBitset(const std::size_t t_size);
+    inline PersistentBitset(const RuntimeBitset& t_bitset);
+    inline PersistentBitset(); // Default constructor
+    // Copies only copy the root, they are the same version
+    ~PersistentBitset() = default;
+    PersistentBitset(const PersistentBitset&) = default;
+    PersistentBitset& operator=(const PersistentBitset&) = default;
+    PersistentBitset(PersistentBitset&&) = default;
+    PersistentBitset& operator=(PersistentBitset&&) = default;
+
+    inline std::string to_string() const;
+    inline RuntimeBitset toRuntimeBitset() const;
+
+    // NORMAL MEMBERS
+    inline bool operator[](std::size_t t_position) const;
+    inline bool test(std::size_t t_position) const;
+
+    inline bool all() const noexcept;
+    inline bool any() const noexcept;
+    inline bool none() const noexcept;
+
+    inline std::size_t count() const noexcept;
+
+    // Capacity
+    inline std::size_t size() const noexcept {return m_size;}
+    // Number of chunks allocated in this version (shared or not with other versions)
+    inline std::size_t allocatedChunks() const noexcept;
+    // True if both versions are exactly the same tree
+    inline bool sameVersion(const PersistentBitset& t_other) const noexcept {return m_root == t_other.m_root;}
+
+    // Modifiers, they return the new version (if nothing changes, the same version)
+    [[nodiscard]] inline PersistentBitset set(const std::size_t t_position) const;
+    [[nodiscard]] inline PersistentBitset reset(const std::size_t t_position) const;
+    [[nodiscard]] inline PersistentBitset flip(const std::size_t t_position) const;
+    // The no significant bits of t_value are ignored
+    [[nodiscard]] inline PersistentBitset setBlock(const std::size_t t_block, const std::size_t t_value) const;
+    inline std::size_t getBlock(const std::size_t t_block) const;
+
+    // Number of blocks of each chunk (512 bytes with blocks of 64 bits)
+    inline static constexpr std::size_t CHUNK_BLOCKS = 64;
+    // Children of each inner node of the tree
+    inline static constexpr std::size_t BRANCHES = 32;
+
+  private:
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    inline static constexpr std::size_t ALL_BITS_ONE = ~static_cast<std::size_t>(0);
+
+    // The leaves only have blocks, the rest only children (nullptr is a subtree of 0)
+    struct Node {
+      std::vector<std::shared_ptr<const Node>> children;
+      std::vector<std::size_t> blocks;
+    };
+    using NodePointer = std::shared_ptr<const Node>;
+
+    // PRIVATE METHODS
+    inline void build(const std::size_t t_size);
+    inline std::size_t getMask(const std::size_t t_block) const noexcept;
+    // Number of blocks under a node of the level t_level (0 are the leaves)
+    inline static std::size_t getSpan(const std::size_t t_level) noexcept;
+    inline std::size_t readBlock(const std::size_t t_block) const noexcept;
+    // Copy of the path to t_block with the new value, the rest of children are shared
+    inline static NodePointer writeBlock(const NodePointer& t_node, const std::size_t t_level,
+      const std::size_t t_block, const std::size_t t_value);
+    // Subtree with the blocks of t_bitset, nullptr if all of them are 0
+    inline static NodePointer buildNode(const RuntimeBitset& t_bitset, const std::size_t t_level,
+      const std::size_t t_first);
+    // Apply t_function to each allocated chunk, with the number of its first block
+    template <typename Function>
+    inline static void forEachChunk(const NodePointer& t_node, const std::size_t t_level,
+      const std::size_t t_first, Function& t_function);
+    inline void checkPosition(const std::size_t t_position) const;
+
+    // Attributes
+    NodePointer m_root; // little endian
+    std::size_t m_levels = 0; // levels over the leaves
+    std::size_t m_size = 0;
+    std::size_t m_blocks = 0;
+    std::size_t m_lastMask = 0; // mask of the most significant block
+};
+
+} // namespace RunBitset
+
+
+RunBitset::PersistentBitset::PersistentBitset(const std::size_t t_size) {
+  build(t_size);
+}
+
+RunBitset::PersistentBitset::PersistentBitset(const RuntimeBitset& t_bitset) {
+  build(t_bitset.size());
+  m_root = buildNode(t_bitset, m_levels, 0);
+}
+
+RunBitset::PersistentBitset::PersistentBitset() {
+  build(BLOCK_SIZE);
+}
+
+std::string RunBitset::PersistentBitset::to_string() const {
+  std::string toReturn(m_size, '0');
+  auto write = [&](const Node& t_chunk, const std::size_t t_first) {
+    for (std::size_t i = 0; i < CHUNK_BLOCKS && t_first + i < m_blocks; ++i) {
+      std::size_t block = t_chunk.blocks[i] & getMask(t_first + i);
+      for (; block != 0; block &= block - 1) {
+        const std::size_t position = (t_first + i) * BLOCK_SIZE + std::countr_zero(block);
+        toReturn[m_size - 1 - position] = '1'; // the most significant bit is the first character
+      }
+    }
+  };
+  forEachChunk(m_root, m_levels, 0, write);
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::PersistentBitset::toRuntimeBitset() const {
+  RuntimeBitset toReturn(m_size);
+  auto write = [&](const Node& t_chunk, const std::size_t t_first) {
+    for (std::size_t i = 0; i < CHUNK_BLOCKS && t_first + i < m_blocks; ++i) {
+      if (t_chunk.blocks[i] != 0) toReturn.setBlock(t_first + i, t_chunk.blocks[i]);
+    }
+  };
+  forEachChunk(m_root, m_levels, 0, write);
+  return toReturn;
+}
+
+bool RunBitset::PersistentBitset::operator[](std::size_t t_position) const {
+  return test(t_position);
+}
+
+bool RunBitset::PersistentBitset::test(std::size_t t_position) const {
+  checkPosition(t_position);
+  return (readBlock(t_position / BLOCK_SIZE) >> (t_position % BLOCK_SIZE)) & 1;
+}
+
+bool RunBitset::PersistentBitset::all() const noexcept {
+  return count() == m_size;
+}
+
+bool RunBitset::PersistentBitset::any() const noexcept {
+  return count() != 0;
+}
+
+bool RunBitset::PersistentBitset::none() const noexcept {
+  return count() == 0;
+}
+
+std::size_t RunBitset::PersistentBitset::count() const noexcept {
+  std::size_t numberOfActive = 0;
+  auto countChunk = [&](const Node& t_chunk, const std::size_t t_first) {
+    for (std::size_t i = 0; i < CHUNK_BLOCKS && t_first + i < m_blocks; ++i) {
+      numberOfActive += std::popcount(t_chunk.blocks[i] & getMask(t_first + i));
+    }
+  };
+  forEachChunk(m_root, m_levels, 0, countChunk);
+  return numberOfActive;
+}
+
+std::size_t RunBitset::PersistentBitset::allocatedChunks() const noexcept {
+  std::size_t chunks = 0;
+  auto countChunk = [&](const Node&, const std::size_t) {++chunks;};
+  forEachChunk(m_root, m_levels, 0, countChunk);
+  return chunks;
+}
+
+RunBitset::PersistentBitset RunBitset::PersistentBitset::set(const std::size_t t_position) const {
+  checkPosition(t_position);
+  const std::size_t block = t_position / BLOCK_SIZE;
+  return setBlock(block, readBlock(block) | (static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE)));
+}
+
+RunBitset::PersistentBitset RunBitset::PersistentBitset::reset(const std::size_t t_position) const {
+  checkPosition(t_position);
+  const std::size_t block = t_position / BLOCK_SIZE;
+  return setBlock(block, readBlock(block) & ~(static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE)));
+}
+
+RunBitset::PersistentBitset RunBitset::PersistentBitset::flip(const std::size_t t_position) const {
+  checkPosition(t_position);
+  const std::size_t block = t_position / BLOCK_SIZE;
+  return setBlock(block, readBlock(block) ^ (static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE)));
+}
+
+RunBitset::PersistentBitset
+RunBitset::PersistentBitset::setBlock(const std::size_t t_block, const std::size_t t_value) const {
+  if (t_block >= m_blocks) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  const std::size_t value = t_value & getMask(t_block);
+  if (readBlock(t_block) == value) return *this; // nothing to copy
+  PersistentBitset toReturn(*this);
+  toReturn.m_root = writeBlock(m_root, m_levels, t_block, value);
+  return toReturn;
+}
+
+std::size_t RunBitset::PersistentBitset::getBlock(const std::size_t t_block) const {
+  if (t_block >= m_blocks) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  return readBlock(t_block);
+}
+
+void RunBitset::PersistentBitset::build(const std::size_t t_size) {
+  // Bitsets of size 0 breaks the implementation
+  if (t_size == 0) throw (RunBitsetException::RuntimeBitsetInvalidSize());
+  m_size = t_size;
+  m_blocks = (t_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  m_lastMask = ALL_BITS_ONE >> (m_blocks * BLOCK_SIZE - t_size);
+  // Minimal height to cover all the blocks, the root of 0 is not allocated
+  m_levels = 0;
+  while (getSpan(m_levels) < m_blocks) ++m_levels;
+  m_root = nullptr;
+}
+
+std::size_t RunBitset::PersistentBitset::getMask(const std::size_t t_block) const noexcept {
+  return (t_block == m_blocks - 1) ? m_lastMask : ALL_BITS_ONE;
+}
+
+std::size_t RunBitset::PersistentBitset::getSpan(const std::size_t t_level) noexcept {
+  std::size_t span = CHUNK_BLOCKS;
+  for (std::size_t l = 0; l < t_level; ++l) {
+    span *= BRANCHES;
+  }
+  return span;
+}
+
+std::size_t RunBitset::PersistentBitset::readBlock(const std::size_t t_block) const noexcept {
+  const Node* node = m_root.get();
+  std::size_t block = t_block;
+  for (std::size_t level = m_levels; level > 0; --level) {
+    if (node == nullptr) return 0;
+    const std::size_t span = getSpan(level - 1);
+    node = node->children[block / span].get();
+    block %= span;
+  }
+  if (node == nullptr) return 0;
+  return node->blocks[block] & getMask(t_block);
+}
+
+RunBitset::PersistentBitset::NodePointer RunBitset::PersistentBitset::writeBlock
+(const NodePointer& t_node, const std::size_t t_level, const std::size_t t_block, const std::size_t t_value) {
+  std::shared_ptr<Node> copy;
+  if (t_node != nullptr) copy = std::make_shared<Node>(*t_node); // only the pointers of the children
+  else {
+    copy = std::make_shared<Node>();
+    if (t_level == 0) copy->blocks.assign(CHUNK_BLOCKS, 0);
+    else copy->children.assign(BRANCHES, nullptr);
+  }
+  if (t_level == 0) {
+    copy->blocks[t_block] = t_value;
+    return copy;
+  }
+  const std::size_t span = getSpan(t_level - 1);
+  NodePointer& child = copy->children[t_block / span];
+  child = writeBlock(child, t_level - 1, t_block % span, t_value);
+  return copy;
+}
+
+RunBitset::PersistentBitset::NodePointer RunBitset::PersistentBitset::buildNode
+(const RuntimeBitset& t_bitset, const std::size_t t_level, const std::size_t t_first) {
+  if (t_first >= t_bitset.blocks()) return nullptr;
+  std::shared_ptr<Node> node = std::make_shared<Node>();
+  bool empty = true;
+  if (t_level == 0) {
+    node->blocks.assign(CHUNK_BLOCKS, 0);
+    const std::size_t last = std::min(t_first + CHUNK_BLOCKS, t_bitset.blocks());
+    for (std::size_t i = t_first; i < last; ++i) {
+      node->blocks[i - t_first] = t_bitset.getBlock(i);
+      if (node->blocks[i - t_first] != 0) empty = false;
+    }
+  }
+  else {
+    node->children.assign(BRANCHES, nullptr);
+    const std::size_t span = getSpan(t_level - 1);
+    for (std::size_t c = 0; c < BRANCHES; ++c) {
+      node->children[c] = buildNode(t_bitset, t_level - 1, t_first + c * span);
+      if (node->children[c] != nullptr) empty = false;
+    }
+  }
+  if (empty) return nullptr;
+  return node;
+}
+
+template <typename Function>
+void RunBitset::PersistentBitset::forEachChunk
+(const NodePointer& t_node, const std::size_t t_level, const std::size_t t_first, Function& t_function) {
+  if (t_node == nullptr) return; // nothing in a subtree of 0
+  if (t_level == 0) {
+    t_function(*t_node, t_first);
+    return;
+  }
+  const std::size_t span = getSpan(t_level - 1);
+  for (std::size_t c = 0; c < BRANCHES; ++c) {
+    forEachChunk(t_node->children[c], t_level - 1, t_first + c * span, t_function);
+  }
+}
+
+void RunBitset::PersistentBitset::checkPosition(const std::size_t t_position) const {
+  if (t_position >= m_size) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+}
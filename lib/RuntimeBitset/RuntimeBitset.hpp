@@ -16,23 +16,105 @@
 #include <sstream>
 #include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <new>
+#include <bit>
+#include <type_traits>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <array>
+#include <ios>
+#include <limits>
+#include <locale>
+#include <memory>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// std::formatter only if the standard library has <format>
+#if __has_include(<format>)
+#include <format>
+#endif
+
+// Non temporal stores of 16 bytes (two blocks), only with SSE2 and blocks of 64 bits
+#if defined(__SSE2__) && defined(__x86_64__) && !defined(__ILP32__)
+#include <emmintrin.h>
+#define RUNBITSET_STREAMING_STORES
+#endif
+
+// Hex digits of a whole block (16 chars) with shuffles, only with SSSE3 and blocks of 64 bits
+#if defined(__SSSE3__) && defined(__x86_64__) && !defined(__ILP32__)
+#include <tmmintrin.h>
+#define RUNBITSET_SSSE3_HEX
+#endif
 
 namespace RunBitset {
 
+// Tag of the constructor that doesn´t initialize the bits
+struct uninitialized_t {
+  explicit uninitialized_t() = default;
+};
+inline constexpr uninitialized_t uninitialized{};
+
+// Text formats of operator<< and operator>>, binary (one char per bit) by default
+// Example: std::cout << RunBitset::hexFormat << bitset;
+inline std::ios_base& binaryFormat(std::ios_base& t_stream);
+inline std::ios_base& hexFormat(std::ios_base& t_stream);
+inline std::ios_base& base64Format(std::ios_base& t_stream);
+
+// Binary files (RuntimeBitsetIO.hpp)
+class BitsetFile;
+// Merge of the shards (ShardedBitsetAccumulator.hpp)
+class ShardedBitsetAccumulator;
+
 class RuntimeBitset {
   public:
     // SPECIAL MEMBERS
-    RuntimeBitset(const std::size_t t_size, const std::size_t t_num);
-    RuntimeBitset(const std::size_t t_size);
-    RuntimeBitset(const std::string& t_string);
-    RuntimeBitset(); // Default constructor
-    ~RuntimeBitset(); // Destructor
+    inline RuntimeBitset(const std::size_t t_size, const std::size_t t_num);
+    inline RuntimeBitset(const std::size_t t_size);
+    // The bits are not initialized, for bitsets that will be overwritten completely
+    inline RuntimeBitset(const std::size_t t_size, uninitialized_t);
+    inline RuntimeBitset(const std::string& t_string);
+    inline RuntimeBitset(); // Default constructor
+    inline ~RuntimeBitset(); // Destructor
     inline RuntimeBitset(const RuntimeBitset& t_RuntimeBitset); // Copy constructor
     inline RuntimeBitset& operator=(const RuntimeBitset& t_RuntimeBitset); // Copy assignment
     inline RuntimeBitset(RuntimeBitset&& t_RuntimeBitset); // Move constructor
     inline RuntimeBitset& operator=(RuntimeBitset&& t_RuntimeBitset); // Move assignment
 
     inline std::string to_string() const noexcept;
+    // Denser text formats, the most significant digit first like to_string()
+    // Hex is 4 bits per char (0-9a-f, A-F also parsed), base64 is 6 bits per char (A-Za-z0-9+/, without padding)
+    // The size of the parsed bitset is 4 (or 6) bits per char if t_size is 0, 
+    //   with t_size the bits out of the size are ignored
+    inline std::string to_hex() const;
+    inline std::string to_base64() const;
+    inline static RuntimeBitset from_hex(const std::string& t_string, const std::size_t t_size = 0);
+    inline static RuntimeBitset from_base64(const std::string& t_string, const std::size_t t_size = 0);
+
+    // Format of std::format, {:[hN|tN][sG][b|x|X]}
+    //   hN only the N head (most significant) bits, tN only the N tail (less significant) bits
+    //   (not < and >, they are the align of the standard spec and would mean something else)
+    //   sG the separator s (_ ' , . : or space) every G digits, starting by the less significant
+    //   b binary (by default), x hex, X hex in upper case
+    // Example: std::format("{:t12_4}", bitset) -> the 12 less significant bits, "0111_1111_0000"
+    struct FormatSpec {
+      std::size_t leading = 0; // 0 is all
+      std::size_t trailing = 0;
+      char separator = 0;
+      std::size_t group = 0; // 0 without separator
+      char type = 'b';
+    };
+    // t_position stops in the first char that is not part of the spec, false if the spec is wrong
+    template <typename Iterator>
+    inline static constexpr bool parseFormat(Iterator& t_position, const Iterator t_end, FormatSpec& t_spec) noexcept;
+    // Write the digits in t_out, by batches of one block of digits, without any string
+    template <typename OutputIterator>
+    inline OutputIterator formatTo(OutputIterator t_out, const FormatSpec& t_spec) const;
     inline unsigned long long to_ullong() const noexcept;
     inline unsigned long to_ulong() const noexcept;
 
@@ -47,39 +129,165 @@ class RuntimeBitset {
 
     inline std::size_t count() const noexcept;
 
+    // Cached count: modifiers keep the number of active bits updated, so count() is O(1)
+    // Single bit modifiers are a bit slower (they have to check the old value)
+    inline void enableCountCache() noexcept;
+    inline void disableCountCache() noexcept;
+    inline bool isCountCached() const noexcept {return m_countCached;}
+
+    // Find the first active bit starting in t_position, returns size() if there isn´t any
+    inline std::size_t find_first() const noexcept;
+    inline std::size_t find_next(const std::size_t t_position) const noexcept;
+
+    // Summary: one bit per block (1 if the block has any active bit), one bit per 
+    //   word of the previous level and so on, until a level of only one word
+    // With it, any(), none(), count(), find and & skip the empty blocks
+    inline void enableSummary();
+    inline void disableSummary() noexcept;
+    inline bool hasSummary() const noexcept {return m_hasSummary;}
+
     // Capacity
     inline std::size_t size() const noexcept {return m_size;}
 
+    // Blocks, the bit j of the block i is the position (i * blockSize() + j)
+    // Used by the other containers of the library to copy the bitset block by block
+    inline static constexpr std::size_t blockSize() noexcept {return BLOCK_SIZE;}
+    inline std::size_t blocks() const noexcept {return m_blocks;}
+    // Only the significant bits, the rest are 0
+    inline std::size_t getBlock(const std::size_t t_block) const;
+    // The no significant bits of t_value are ignored
+    inline RuntimeBitset& setBlock(const std::size_t t_block, const std::size_t t_value);
+
+    // Huge pages: the blocks of the bitsets of at least threshold bytes are allocated aligned 
+    //   to HUGE_PAGE_SIZE and marked with madvise(MADV_HUGEPAGE), less TLB misses in random access
+    // With RUNBITSET_USE_HUGETLB defined, it tries first with MAP_HUGETLB (reserved huge pages)
+    // Only in linux, in the rest (or if the mapping fails) the blocks are allocated as always
+    inline static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    inline static void setHugePageThreshold(const std::size_t t_bytes) noexcept;
+    inline static std::size_t getHugePageThreshold() noexcept;
+    inline bool usesHugePages() const noexcept {return m_mappedBytes != 0;}
+
+    // Streaming stores: set(), reset() and the binary operators write the blocks of 
+    //   the bitsets of at least threshold bytes with non temporal stores, so a bitset much bigger
+    //   than the cache doesn´t evict the working set (the sources are prefetched instead)
+    // Not &=, |= and ^=, they read the blocks they write, and streaming them is slower
+    inline static void setStreamingThreshold(const std::size_t t_bytes) noexcept;
+    inline static std::size_t getStreamingThreshold() noexcept;
+
+    // Copy on write: the copies share the blocks, so a copy (a snapshot) is O(1)
+    //   the first modifier called in any of them copies the blocks before writing
+    // With t_threadSafe the counter of references is atomic, needed if the copies go to other threads
+    // The copies of a copy on write bitset are copy on write too
+    inline void enableCopyOnWrite(const bool t_threadSafe = false);
+    inline void disableCopyOnWrite();
+    inline bool isCopyOnWrite() const noexcept {return m_shared != nullptr;}
+    // True if the blocks are shared with other bitset
+    inline bool isShared() const noexcept;
+
+    // Dirty tracking: one bit per page of DIRTY_PAGE_BLOCKS blocks, set by every modifier,
+    //   so a snapshot only has to write again the modified pages
+    // With t_journal each modified block is also appended to the journal (block, new value)
+    // It belongs to the object, the copies don´t have it, and an assignment makes all the pages dirty
+    inline static constexpr std::size_t DIRTY_PAGE_BLOCKS = 512;
+    struct JournalEntry {
+      std::size_t block;
+      std::size_t value;
+    };
+    // It starts without dirty pages
+    inline void enableDirtyTracking(const bool t_journal = false);
+    inline void disableDirtyTracking() noexcept;
+    inline bool isDirtyTracked() const noexcept {return m_dirtyTracked;}
+    // Blocks [first, last) of the dirty pages, the consecutive pages are merged
+    inline std::vector<std::pair<std::size_t, std::size_t>> dirtyRanges() const;
+    inline void clearDirty() noexcept;
+    inline const std::vector<JournalEntry>& journal() const noexcept {return m_journal;}
+    inline void clearJournal() noexcept;
+
     // Extra
     inline void printDebug() const noexcept;
  
     // Modifiers
-    inline RuntimeBitset& set() noexcept;
+    // The modifiers can allocate, if the blocks are shared (copy on write)
+    inline RuntimeBitset& set();
     inline RuntimeBitset& set(const std::size_t t_position);
-    inline RuntimeBitset& reset() noexcept;
+    inline RuntimeBitset& reset();
     inline RuntimeBitset& reset(const std::size_t t_position);   
-    inline RuntimeBitset& flip() noexcept;
+    inline RuntimeBitset& flip();
     inline RuntimeBitset& flip(const std::size_t t_position);
 
     // Modifiers
     inline RuntimeBitset& operator&=(const RuntimeBitset& t_other);
     inline RuntimeBitset& operator|=(const RuntimeBitset& t_other);
     inline RuntimeBitset& operator^=(const RuntimeBitset& t_other);
-    inline RuntimeBitset operator~();
 
-    inline RuntimeBitset operator<<(std::size_t t_pos) const;
+    class ComplementView;
+    // Doesn´t modify the bitset, the complement is applied when the view is read
+    inline ComplementView operator~() const& noexcept;
+    // A view of a temporary would dangle, so the temporary is complemented (in place if it can be moved)
+    inline RuntimeBitset operator~() &&;
+    inline RuntimeBitset operator~() const&&;
+    inline RuntimeBitset& operator&=(const ComplementView& t_other);
+    inline RuntimeBitset& operator|=(const ComplementView& t_other);
+    inline RuntimeBitset& operator^=(const ComplementView& t_other);
+
+    class ShiftView;
+    // Doesn´t copy the bitset, the shift is applied when the view is read
+    inline ShiftView operator<<(std::size_t t_pos) const& noexcept;
+    inline ShiftView operator>>(std::size_t t_pos) const& noexcept;
+    // Same as operator~, a temporary is shifted (in place if it can be moved)
+    inline RuntimeBitset operator<<(std::size_t t_pos) &&;
+    inline RuntimeBitset operator<<(std::size_t t_pos) const&&;
+    inline RuntimeBitset operator>>(std::size_t t_pos) &&;
+    inline RuntimeBitset operator>>(std::size_t t_pos) const&&;
     inline RuntimeBitset& operator<<=(std::size_t t_pos);
-    inline RuntimeBitset operator>>(std::size_t t_pos) const;
     inline RuntimeBitset& operator>>=(std::size_t t_pos);
+    inline RuntimeBitset& operator&=(const ShiftView& t_other);
+    inline RuntimeBitset& operator|=(const ShiftView& t_other);
+    inline RuntimeBitset& operator^=(const ShiftView& t_other);
 
     // Binary logic operators
     friend inline RuntimeBitset operator&(const RuntimeBitset& t_1, const RuntimeBitset& t_2);
     friend inline  RuntimeBitset operator|(const RuntimeBitset& t_1, const RuntimeBitset& t_2);
     friend inline RuntimeBitset operator^(const RuntimeBitset& t_1, const RuntimeBitset& t_2);
+    // The complement is absorbed in the operation (a & ~b is and-not, no temporary ~b)
+    friend inline RuntimeBitset operator&(const RuntimeBitset& t_1, const ComplementView& t_2);
+    friend inline RuntimeBitset operator&(const ComplementView& t_1, const RuntimeBitset& t_2);
+    friend inline RuntimeBitset operator&(const ComplementView& t_1, const ComplementView& t_2);
+    friend inline RuntimeBitset operator|(const RuntimeBitset& t_1, const ComplementView& t_2);
+    friend inline RuntimeBitset operator|(const ComplementView& t_1, const RuntimeBitset& t_2);
+    friend inline RuntimeBitset operator|(const ComplementView& t_1, const ComplementView& t_2);
+    friend inline RuntimeBitset operator^(const RuntimeBitset& t_1, const ComplementView& t_2);
+    friend inline RuntimeBitset operator^(const ComplementView& t_1, const RuntimeBitset& t_2);
+    friend inline RuntimeBitset operator^(const ComplementView& t_1, const ComplementView& t_2);
+    // The shifted blocks are read on the fly, (a << 3) & b doesn´t build a << 3
+    friend inline RuntimeBitset operator&(const RuntimeBitset& t_1, const ShiftView& t_2);
+    friend inline RuntimeBitset operator&(const ShiftView& t_1, const RuntimeBitset& t_2);
+    friend inline RuntimeBitset operator&(const ShiftView& t_1, const ShiftView& t_2);
+    friend inline RuntimeBitset operator&(const ShiftView& t_1, const ComplementView& t_2);
+    friend inline RuntimeBitset operator&(const ComplementView& t_1, const ShiftView& t_2);
+    friend inline RuntimeBitset operator|(const RuntimeBitset& t_1, const ShiftView& t_2);
+    friend inline RuntimeBitset operator|(const ShiftView& t_1, const RuntimeBitset& t_2);
+    friend inline RuntimeBitset operator|(const ShiftView& t_1, const ShiftView& t_2);
+    friend inline RuntimeBitset operator|(const ShiftView& t_1, const ComplementView& t_2);
+    friend inline RuntimeBitset operator|(const ComplementView& t_1, const ShiftView& t_2);
+    friend inline RuntimeBitset operator^(const RuntimeBitset& t_1, const ShiftView& t_2);
+    friend inline RuntimeBitset operator^(const ShiftView& t_1, const RuntimeBitset& t_2);
+    friend inline RuntimeBitset operator^(const ShiftView& t_1, const ShiftView& t_2);
+    friend inline RuntimeBitset operator^(const ShiftView& t_1, const ComplementView& t_2);
+    friend inline RuntimeBitset operator^(const ComplementView& t_1, const ShiftView& t_2);
+
+    // Delta between two versions of the same bitset, to send only the changes
+    // Format: varint size, then records (varint blocks skipped, varint n, n blocks of t_old ^ t_new)
+    //   the blocks are little endian, the blocks that didn´t change are never written
+    friend inline std::vector<std::uint8_t> diff(const RuntimeBitset& t_old, const RuntimeBitset& t_new);
+    // Apply the delta in one pass, t_bitset must have the size of the versions of the delta
+    friend inline void apply_patch(RuntimeBitset& t_bitset, const std::vector<std::uint8_t>& t_delta);
 
     // iostream operators
     friend inline std::ostream& operator<<(std::ostream& os, const RuntimeBitset& t_bitset);
     friend inline std::istream& operator>>(std::istream& is, RuntimeBitset& t_bitset);
+    friend inline std::ostream& operator<<(std::ostream& os, const ComplementView& t_view);
+    friend inline std::ostream& operator<<(std::ostream& os, const ShiftView& t_view);
 
     class Reference {
       public:
@@ -103,21 +311,192 @@ class RuntimeBitset {
     };
 
     inline Reference operator[](std::size_t t_pos);
+
+    // Read only view of the complement of a bitset, it is never stored
+    // The view must not outlive the bitset
+    class ComplementView {
+      public:
+        explicit ComplementView(const RuntimeBitset& t_bitset) : m_bitset(t_bitset) {}
+        ~ComplementView() = default;
+        ComplementView(const ComplementView&) = default;
+        ComplementView& operator=(const ComplementView&) = delete;
+
+        inline std::size_t size() const noexcept {return m_bitset.size();}
+        inline bool operator[](std::size_t t_position) const;
+        inline bool test(std::size_t t_position) const;
+        inline bool all() const noexcept;
+        inline bool any() const noexcept;
+        inline bool none() const noexcept;
+        inline std::size_t count() const noexcept;
+        inline std::size_t find_first() const noexcept;
+        inline std::size_t find_next(const std::size_t t_position) const noexcept;
+        inline std::string to_string() const noexcept;
+
+        // Writing materializes the complement, they return a new bitset (the viewed one is not modified)
+        // nodiscard: auto v = ~a; v.set(3); would lose the write without any warning
+        [[nodiscard]] inline RuntimeBitset set() const;
+        [[nodiscard]] inline RuntimeBitset set(const std::size_t t_position) const;
+        [[nodiscard]] inline RuntimeBitset reset() const;
+        [[nodiscard]] inline RuntimeBitset reset(const std::size_t t_position) const;
+        [[nodiscard]] inline RuntimeBitset flip() const;
+        [[nodiscard]] inline RuntimeBitset flip(const std::size_t t_position) const;
+
+        // ~~bitset is the bitset itself
+        inline const RuntimeBitset& operator~() const noexcept {return m_bitset;}
+        // (~a) << 3 is a view of a too
+        inline ShiftView operator<<(std::size_t t_pos) const;
+        inline ShiftView operator>>(std::size_t t_pos) const;
+        // Materialize the complement
+        inline operator RuntimeBitset() const;
+      private:
+        friend class RuntimeBitset;
+        const RuntimeBitset& m_bitset;
+    };
+
+    // Read only view of a shifted bitset, it only stores the offset
+    // Position i of the view is the position (i - offset) of the bitset (complemented if complement),
+    //   inside [first, last), the rest of positions are fill (0 if they were shifted out or shifted in)
+    // The view must not outlive the bitset
+    class ShiftView {
+      public:
+        ShiftView(const RuntimeBitset& t_bitset, const long long t_offset, 
+          const std::size_t t_first, const std::size_t t_last, const bool t_complement = false, const bool t_fill = false) 
+        : m_bitset(&t_bitset), m_offset(t_offset), m_first(t_first), m_last(t_last), 
+          m_complement(t_complement), m_fill(t_fill) {}
+        ~ShiftView() = default;
+        ShiftView(const ShiftView&) = default;
+        ShiftView& operator=(const ShiftView&) = delete;
+
+        inline std::size_t size() const noexcept {return m_bitset->size();}
+        inline bool operator[](std::size_t t_position) const;
+        inline bool test(std::size_t t_position) const;
+        inline bool all() const noexcept;
+        inline bool any() const noexcept;
+        inline bool none() const noexcept;
+        inline std::size_t count() const noexcept;
+        inline std::size_t find_first() const noexcept;
+        inline std::size_t find_next(const std::size_t t_position) const noexcept;
+        inline std::string to_string() const noexcept;
+
+        // Writing materializes the shift, they return a new bitset (the viewed one is not modified)
+        // nodiscard: auto v = a << 3; v.set(3); would lose the write without any warning
+        [[nodiscard]] inline RuntimeBitset set() const;
+        [[nodiscard]] inline RuntimeBitset set(const std::size_t t_position) const;
+        [[nodiscard]] inline RuntimeBitset reset() const;
+        [[nodiscard]] inline RuntimeBitset reset(const std::size_t t_position) const;
+        [[nodiscard]] inline RuntimeBitset flip() const;
+        [[nodiscard]] inline RuntimeBitset flip(const std::size_t t_position) const;
+
+        // Shifting a view only moves the offset, (a << 3) >> 1 is still a view of a
+        // A complemented view has the fill to 1, its shift is materialized (the view keeps it)
+        inline ShiftView operator<<(std::size_t t_pos) const;
+        inline ShiftView operator>>(std::size_t t_pos) const;
+        // Like the complement of a bitset, ~(a << 3) is still a view of a
+        inline ShiftView operator~() const noexcept;
+        // Materialize the shift
+        inline operator RuntimeBitset() const;
+      private:
+        friend class RuntimeBitset;
+        // View of a materialized bitset, it is owned by the view (and its copies)
+        inline explicit ShiftView(std::shared_ptr<const RuntimeBitset> t_owned);
+        // Block t_block of the shifted bitset, no significant bits are 0
+        inline std::size_t getBlock(const std::size_t t_block) const noexcept;
+
+        const RuntimeBitset* m_bitset;
+        std::shared_ptr<const RuntimeBitset> m_owned; // only if the view had to be materialized
+        long long m_offset;
+        std::size_t m_first;
+        std::size_t m_last;
+        bool m_complement; // of the bits inside [first, last)
+        bool m_fill; // value of the bits outside [first, last)
+    };
   private:
+    // The binary files read and write the blocks directly
+    friend class BitsetFile;
+    // The merge writes disjoint ranges of blocks from several threads
+    friend class ShardedBitsetAccumulator;
+
     // STATIC MEMBERS
     // Number of bits of each block
     inline static constexpr std::size_t BLOCK_SIZE = sizeof(std::size_t) * 8;
     inline static constexpr std::size_t ALL_BITS_ONE = ~(0);
 
     // PRIVATE METHODS
-    inline void buildBlocks();
+    // If t_zeroed is false the blocks are not initialized
+    inline void buildBlocks(const bool t_zeroed);
+    // Map t_bytes aligned to huge pages, nullptr if it is not possible
+    inline std::size_t* mapHugePages(const std::size_t t_bytes) noexcept;
+    // Free the blocks, with free or munmap
+    inline static void releaseBlocks(std::size_t* t_bits, const std::size_t t_mappedBytes) noexcept;
+    // Number of bitsets that share the blocks (copy on write)
+    struct SharedBlocks {
+      std::size_t references;
+      bool threadSafe;
+    };
+    inline static void addReference(SharedBlocks* t_shared) noexcept;
+    // True if it was the last reference, then t_shared is deleted
+    inline static bool removeReference(SharedBlocks* t_shared) noexcept;
+    inline static std::size_t getReferences(SharedBlocks* t_shared) noexcept;
+    // Called by all the modifiers, if the blocks are shared they are copied first
+    inline void detach();
+    // Called by all the modifiers after writing, marks the pages of the blocks (and journals them)
+    inline void markDirty(const std::size_t t_block);
+    inline void markDirty(const std::size_t t_first, const std::size_t t_last);
+    // All the pages dirty, after the bitset is rebuilt (the number of pages can change)
+    inline void markAllDirty();
+    // Allocate the dirty pages and the journal of markAllDirty with t_blocks blocks, so it doesn´t throw
+    inline void reserveDirty(const std::size_t t_blocks);
+    // Write t_blocks blocks in t_destination, t_block(i) is the value of the block i
+    // With streaming stores t_prefetch(i) is called once per cache line, to prefetch the sources
+    template <typename Function, typename Prefetch>
+    inline static void writeBlocks(std::size_t* t_destination, const std::size_t t_blocks, 
+      Function t_block, Prefetch t_prefetch) noexcept;
+    template <typename Function>
+    inline static void writeBlocks(std::size_t* t_destination, const std::size_t t_blocks, 
+      Function t_block) noexcept;
+    // Prefetch the blocks that will be read PREFETCH_DISTANCE blocks later (nothing in the views)
+    inline static void prefetchBlock(const RuntimeBitset& t_bitset, const std::size_t t_block) noexcept;
+    template <typename View>
+    inline static void prefetchBlock(const View&, const std::size_t) noexcept {}
     inline void buildMask();
     // Call buildBlocks, buildMask
-    inline void build(const std::size_t t_size);
+    inline void build(const std::size_t t_size, const bool t_zeroed = true);
+    // Like build, but the blocks are t_blocks (from malloc, already written), owned by the bitset when it returns
+    // The count, the summary and the dirty pages are not updated
+    inline void adoptBlocks(std::size_t* t_blocks, const std::size_t t_size);
+    // Mask of the significant bits of the block
+    inline std::size_t getMask(const std::size_t t_block) const noexcept;
     inline void clean(); // Put all bits to 0
+    // Count the active bits block by block, ignoring the cache
+    inline std::size_t countBlocks() const noexcept;
+    // Update the cached count after a bulk modification
+    inline void recount() noexcept;
+    // Update the summary after a modification in the block t_block
+    inline void updateSummary(const std::size_t t_block) noexcept;
+    // Update the summary after a bulk modification
+    inline void rebuildSummary();
+    // All the levels of the summary to 0, it only allocates if the number of blocks changed
+    inline void resetSummary();
+    // Levels of a summary of t_blocks blocks, all 0
+    inline static std::vector<std::vector<std::size_t>> emptySummary(const std::size_t t_blocks);
+    // Build the upper levels of the summary from the first one
+    inline void buildSummaryLevels() noexcept;
+    // First block with active bits starting in t_block (m_blocks if there isn´t any)
+    inline std::size_t nextActiveBlock(const std::size_t t_block) const noexcept;
+    // First active position in the level t_level starting in t_position, or npos
+    inline std::size_t nextInSummary(const std::size_t t_level, const std::size_t t_position) const noexcept;
+    inline static constexpr std::size_t npos = static_cast<std::size_t>(-1);
     inline void destroy(); // Destroy the object
     inline static void copy(RuntimeBitset& t_copy, const RuntimeBitset& t_toCopy);
+    // Allocate all the memory that copyModes and markAllDirty need, before t_copy is modified
+    //   returns the summary for t_copy (a copy of the one of t_toCopy, or empty levels to rebuild it)
+    inline static std::vector<std::vector<std::size_t>> reserveModes(RuntimeBitset& t_copy, const RuntimeBitset& t_toCopy);
+    // Count and summary of t_copy after copying the blocks, t_summary is the one of reserveModes
+    inline static void copyModes(RuntimeBitset& t_copy, const RuntimeBitset& t_toCopy, 
+      std::vector<std::vector<std::size_t>>& t_summary);
     inline static void move(RuntimeBitset& t_copy, RuntimeBitset& t_toMove);
+    // Exchange all the attributes, except the dirty tracking (it belongs to the object)
+    inline void swap(RuntimeBitset& t_other) noexcept;
     // Method to calculate the number of needed blocks
     inline static std::size_t getNumberBlocks(const std::size_t t_size) noexcept;
     // Method to calculate the mask of the last block
@@ -135,12 +514,95 @@ class RuntimeBitset {
     inline void bitwiseRight(std::size_t t_pos);
 
     inline void buildFromString(const std::string& t_string);
+    // Each char is t_bits bits, t_table gives its value (-1 if it is not valid)
+    inline void buildFromDigits(const std::string& t_string, const std::size_t t_bits, 
+      const std::array<signed char, 256>& t_table, const std::size_t t_size);
+    inline std::string toDigits(const std::size_t t_bits, const char* t_alphabet) const;
+    // The text of a bitset or a view in the format of the stream, the blocks are read with readBlock
+    template <typename Source>
+    inline static void writeText(std::ostream& t_stream, const Source& t_source);
+    // Same as toDigits, but directly to the stream buffer, without a string of the whole bitset
+    // t_block(i) gives the block i of t_size bits, with the non significant bits at 0
+    template <typename BlockFunction>
+    inline static void writeDigits(std::ostream& t_stream, const BlockFunction& t_block, const std::size_t t_size,
+      const std::size_t t_bits, const char* t_alphabet);
+    inline void readDigits(std::istream& t_stream, const std::size_t t_bits, 
+      const std::array<signed char, 256>& t_table);
+    // The bits of t_block in the inverse order
+    inline static constexpr std::size_t reverseBits(std::size_t t_block) noexcept;
+    // Digit i (t_bits bits) starting by the less significant, of t_blocks blocks given by t_block
+    template <typename BlockFunction>
+    inline static std::size_t getDigit(const BlockFunction& t_block, const std::size_t t_blocks,
+      const std::size_t t_digit, const std::size_t t_bits) noexcept;
+    // Chars of the digits [t_first, t_last), the most significant first
+    template <typename BlockFunction>
+    inline static void writeDigitRange(const BlockFunction& t_block, const std::size_t t_blocks, 
+      const std::size_t t_first, const std::size_t t_last, const std::size_t t_bits, 
+      const char* t_alphabet, char* t_destination) noexcept;
+#if defined(RUNBITSET_SSSE3_HEX)
+    // The 16 hex chars of t_block (the most significant first), t_alphabet has 16 chars
+    inline static void encodeHexBlock(const std::size_t t_block, const char* t_alphabet, char* t_destination) noexcept;
+    // The block of 16 hex chars (the most significant first), false if one of them is not hex
+    inline static bool decodeHexBlock(const char* t_chars, std::size_t& t_block) noexcept;
+#endif
+    inline static constexpr std::size_t STREAM_CHUNK = 4096;
+    // Value of each char in the alphabet, -1 for the rest
+    inline static constexpr std::array<signed char, 256> buildDigitTable(const char* t_alphabet, const std::size_t t_digits);
+    inline static constexpr const char* HEX_DIGITS = "0123456789abcdef";
+    inline static constexpr const char* BASE64_DIGITS = 
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    inline static const std::array<signed char, 256>& binaryTable() noexcept;
+    inline static const std::array<signed char, 256>& hexTable() noexcept;
+    inline static const std::array<signed char, 256>& base64Table() noexcept;
+    // Format selected in the stream with the manipulators
+    enum TextFormat {BINARY_FORMAT = 0, HEX_FORMAT, BASE64_FORMAT};
+    inline static long& textFormat(std::ios_base& t_stream);
+    friend inline std::ios_base& binaryFormat(std::ios_base& t_stream);
+    friend inline std::ios_base& hexFormat(std::ios_base& t_stream);
+    friend inline std::ios_base& base64Format(std::ios_base& t_stream);
+
+    // Get BLOCK_SIZE bits starting in t_start, bits out of [0, size) are 0
+    // t_start can be negative or bigger than size (used by ShiftView)
+    inline std::size_t extractBlock(const long long t_start) const noexcept;
+    // Block readers used by the operations, so a view can be used as a bitset
+    inline static std::size_t readBlock(const RuntimeBitset& t_bitset, const std::size_t t_block) noexcept;
+    inline static std::size_t readBlock(const ShiftView& t_view, const std::size_t t_block) noexcept;
+    inline static std::size_t readBlock(const ComplementView& t_view, const std::size_t t_block) noexcept;
+
+    // Delta encoding
+    inline static void writeVarint(std::vector<std::uint8_t>& t_delta, std::size_t t_value);
+    inline static std::size_t readVarint(const std::vector<std::uint8_t>& t_delta, std::size_t& t_position);
+
+    // Apply t_operation block by block, (block of t_1, block of t_2) -> block of the result
+    template <typename Source1, typename Source2, typename Operation>
+    inline static RuntimeBitset binaryOperation
+    (const Source1& t_1, const Source2& t_2, Operation t_operation);
+    // Same, but the result is stored in this
+    template <typename Source, typename Operation>
+    inline void applyOperation(const Source& t_other, Operation t_operation);
+
+    // 64 MB by default
+    inline static std::atomic<std::size_t> s_hugePageThreshold{64 * 1024 * 1024};
+    // 32 MB by default, bigger than the last level cache of most machines
+    inline static std::atomic<std::size_t> s_streamingThreshold{32 * 1024 * 1024};
+    inline static constexpr std::size_t BLOCKS_PER_LINE = 64 / sizeof(std::size_t);
+    inline static constexpr std::size_t PREFETCH_DISTANCE = 8 * BLOCKS_PER_LINE;
 
     // Attributes
     std::size_t* m_bits = nullptr; // little endian
-    std::size_t* m_mask = nullptr; // little endian
-    std::size_t  m_size;
-    std::size_t  m_blocks;
+    std::size_t  m_lastMask = 0; // mask of the most significant block, the rest are ~0
+    std::size_t  m_mappedBytes = 0; // size of the mapping if the blocks are in huge pages, else 0
+    std::size_t  m_size = 0;
+    std::size_t  m_blocks = 0;
+    bool         m_countCached = false;
+    std::size_t  m_count = 0; // only valid if m_countCached
+    bool         m_hasSummary = false;
+    std::vector<std::vector<std::size_t>> m_summary; // level 0 is one bit per block
+    SharedBlocks* m_shared = nullptr; // only with copy on write
+    bool         m_dirtyTracked = false;
+    bool         m_journaled = false;
+    std::vector<std::size_t> m_dirty; // one bit per page
+    std::vector<JournalEntry> m_journal;
 };
 
 } // namespace RunBitset
@@ -174,53 +636,268 @@ class RuntimeBitsetUnknownChar : public RuntimeBitsetException {
   RuntimeBitsetUnknownChar() : RuntimeBitsetException("Unkown character found") {}
 };
 
+class RuntimeBitsetInvalidDelta : public RuntimeBitsetException {
+  public:
+    RuntimeBitsetInvalidDelta() : RuntimeBitsetException("The delta is truncated or corrupted") {}
+};
+
 }
 
 namespace RunBitset {
 
+// Don´t need to apply mask in any of them due it doesn´t affect the significant bits
 RuntimeBitset operator&(const RuntimeBitset& t_1, const RuntimeBitset& t_2) {
-  if (t_1.size() != t_2.size()) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
-  RuntimeBitset aux(t_1.size());
-  for (std::size_t i = 0; i < aux.m_blocks; ++i) {
-    // Don´t need to apply mask due it doesn´t affect the significant bits
-    aux.m_bits[i] = t_1.m_bits[i] & t_2.m_bits[i];
+  if (t_1.m_hasSummary || t_2.m_hasSummary) {
+    if (t_1.size() != t_2.size()) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+    // Only the active blocks of the operand with summary can be active in the result
+    const RuntimeBitset& sparse = t_1.m_hasSummary ? t_1 : t_2;
+    RuntimeBitset aux(t_1.size());
+    for (std::size_t i = sparse.nextActiveBlock(0); i < aux.m_blocks; i = sparse.nextActiveBlock(i + 1)) {
+      aux.m_bits[i] = t_1.m_bits[i] & t_2.m_bits[i];
+    }
+    return aux;
   }
-  return aux;
+  return RuntimeBitset::binaryOperation(t_1, t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a & t_b;});
 }
 
 RuntimeBitset operator|(const RuntimeBitset& t_1, const RuntimeBitset& t_2) {
-  if (t_1.size() != t_2.size()) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
-  RuntimeBitset aux(t_1.size());
-  for (std::size_t i = 0; i < aux.m_blocks; ++i) {
-    // Don´t need to apply mask due it doesn´t affect the significant bits
-    aux.m_bits[i] = t_1.m_bits[i] | t_2.m_bits[i];
-  }
-  return aux;
+  return RuntimeBitset::binaryOperation(t_1, t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a | t_b;});
 }
 
 RuntimeBitset operator^(const RuntimeBitset& t_1, const RuntimeBitset& t_2) {
-  if (t_1.size() != t_2.size()) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
-  RuntimeBitset aux(t_1.size());
-  for (std::size_t i = 0; i < aux.m_blocks; ++i) {
-    // Don´t need to apply mask due it doesn´t affect the significant bits
-    aux.m_bits[i] = t_1.m_bits[i] ^ t_2.m_bits[i];
+  return RuntimeBitset::binaryOperation(t_1, t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a ^ t_b;});
+}
+
+// a & ~b, and-not
+RuntimeBitset operator&(const RuntimeBitset& t_1, const RuntimeBitset::ComplementView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, ~t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a & ~t_b;});
+}
+
+RuntimeBitset operator&(const RuntimeBitset::ComplementView& t_1, const RuntimeBitset& t_2) {
+  return t_2 & t_1;
+}
+
+// ~a & ~b == ~(a | b)
+RuntimeBitset operator&
+(const RuntimeBitset::ComplementView& t_1, const RuntimeBitset::ComplementView& t_2) {
+  return RuntimeBitset::binaryOperation(~t_1, ~t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return ~(t_a | t_b);});
+}
+
+// a | ~b, or-not
+RuntimeBitset operator|(const RuntimeBitset& t_1, const RuntimeBitset::ComplementView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, ~t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a | ~t_b;});
+}
+
+RuntimeBitset operator|(const RuntimeBitset::ComplementView& t_1, const RuntimeBitset& t_2) {
+  return t_2 | t_1;
+}
+
+// ~a | ~b == ~(a & b)
+RuntimeBitset operator|
+(const RuntimeBitset::ComplementView& t_1, const RuntimeBitset::ComplementView& t_2) {
+  return RuntimeBitset::binaryOperation(~t_1, ~t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return ~(t_a & t_b);});
+}
+
+// a ^ ~b == ~(a ^ b), xnor
+RuntimeBitset operator^(const RuntimeBitset& t_1, const RuntimeBitset::ComplementView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, ~t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return ~(t_a ^ t_b);});
+}
+
+RuntimeBitset operator^(const RuntimeBitset::ComplementView& t_1, const RuntimeBitset& t_2) {
+  return t_2 ^ t_1;
+}
+
+// ~a ^ ~b == a ^ b
+RuntimeBitset operator^
+(const RuntimeBitset::ComplementView& t_1, const RuntimeBitset::ComplementView& t_2) {
+  return ~t_1 ^ ~t_2;
+}
+
+// Shift views, the complement is absorbed in the same way
+RuntimeBitset operator&(const RuntimeBitset& t_1, const RuntimeBitset::ShiftView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a & t_b;});
+}
+
+RuntimeBitset operator&(const RuntimeBitset::ShiftView& t_1, const RuntimeBitset& t_2) {
+  return t_2 & t_1;
+}
+
+RuntimeBitset operator&(const RuntimeBitset::ShiftView& t_1, const RuntimeBitset::ShiftView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a & t_b;});
+}
+
+RuntimeBitset operator&
+(const RuntimeBitset::ShiftView& t_1, const RuntimeBitset::ComplementView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, ~t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a & ~t_b;});
+}
+
+RuntimeBitset operator&
+(const RuntimeBitset::ComplementView& t_1, const RuntimeBitset::ShiftView& t_2) {
+  return t_2 & t_1;
+}
+
+RuntimeBitset operator|(const RuntimeBitset& t_1, const RuntimeBitset::ShiftView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a | t_b;});
+}
+
+RuntimeBitset operator|(const RuntimeBitset::ShiftView& t_1, const RuntimeBitset& t_2) {
+  return t_2 | t_1;
+}
+
+RuntimeBitset operator|(const RuntimeBitset::ShiftView& t_1, const RuntimeBitset::ShiftView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a | t_b;});
+}
+
+RuntimeBitset operator|
+(const RuntimeBitset::ShiftView& t_1, const RuntimeBitset::ComplementView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, ~t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a | ~t_b;});
+}
+
+RuntimeBitset operator|
+(const RuntimeBitset::ComplementView& t_1, const RuntimeBitset::ShiftView& t_2) {
+  return t_2 | t_1;
+}
+
+RuntimeBitset operator^(const RuntimeBitset& t_1, const RuntimeBitset::ShiftView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a ^ t_b;});
+}
+
+RuntimeBitset operator^(const RuntimeBitset::ShiftView& t_1, const RuntimeBitset& t_2) {
+  return t_2 ^ t_1;
+}
+
+RuntimeBitset operator^(const RuntimeBitset::ShiftView& t_1, const RuntimeBitset::ShiftView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return t_a ^ t_b;});
+}
+
+RuntimeBitset operator^
+(const RuntimeBitset::ShiftView& t_1, const RuntimeBitset::ComplementView& t_2) {
+  return RuntimeBitset::binaryOperation(t_1, ~t_2, 
+    [](std::size_t t_a, std::size_t t_b) {return ~(t_a ^ t_b);});
+}
+
+RuntimeBitset operator^
+(const RuntimeBitset::ComplementView& t_1, const RuntimeBitset::ShiftView& t_2) {
+  return t_2 ^ t_1;
+}
+
+// Equal lines are skipped with memcmp (vectorized), the last block is compared with its mask
+std::vector<std::uint8_t> diff(const RuntimeBitset& t_old, const RuntimeBitset& t_new) {
+  if (t_old.size() != t_new.size()) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+  constexpr std::size_t LINE = RuntimeBitset::BLOCKS_PER_LINE;
+  auto changes = [&](const std::size_t t_block) {
+    return (t_old.m_bits[t_block] ^ t_new.m_bits[t_block]) & t_old.getMask(t_block);
+  };
+  std::vector<std::uint8_t> delta;
+  RuntimeBitset::writeVarint(delta, t_old.size());
+  std::size_t lastWritten = 0; // end of the last record
+  std::size_t i = 0;
+  while (i < t_old.m_blocks) {
+    while (i + LINE < t_old.m_blocks && 
+      std::memcmp(t_old.m_bits + i, t_new.m_bits + i, LINE * sizeof(std::size_t)) == 0) {
+      i += LINE;
+    }
+    if (changes(i) == 0) {
+      ++i;
+      continue;
+    }
+    std::size_t end = i + 1;
+    while (end < t_old.m_blocks && changes(end) != 0) ++end;
+    RuntimeBitset::writeVarint(delta, i - lastWritten);
+    RuntimeBitset::writeVarint(delta, end - i);
+    for (; i < end; ++i) {
+      const std::size_t block = changes(i);
+      for (std::size_t b = 0; b < sizeof(std::size_t); ++b) {
+        delta.push_back(static_cast<std::uint8_t>(block >> (b * 8)));
+      }
+    }
+    lastWritten = end;
+  }
+  return delta;
+}
+
+void apply_patch(RuntimeBitset& t_bitset, const std::vector<std::uint8_t>& t_delta) {
+  std::size_t position = 0;
+  if (RuntimeBitset::readVarint(t_delta, position) != t_bitset.size()) {
+    throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+  }
+  std::size_t block = 0;
+  while (position < t_delta.size()) {
+    const std::size_t skipped = RuntimeBitset::readVarint(t_delta, position);
+    const std::size_t blocks = RuntimeBitset::readVarint(t_delta, position);
+    if (skipped > t_bitset.m_blocks - block || blocks > t_bitset.m_blocks - block - skipped || 
+      blocks > (t_delta.size() - position) / sizeof(std::size_t)) {
+      throw(RunBitsetException::RuntimeBitsetInvalidDelta());
+    }
+    block += skipped;
+    for (std::size_t end = block + blocks; block < end; ++block) {
+      std::size_t changes = 0;
+      for (std::size_t b = 0; b < sizeof(std::size_t); ++b) {
+        changes |= static_cast<std::size_t>(t_delta[position++]) << (b * 8);
+      }
+      // setBlock keeps the count, the summary and the dirty pages updated
+      t_bitset.setBlock(block, t_bitset.m_bits[block] ^ changes);
+    }
   }
-  return aux;
 }
 
+// The text is written and parsed by chunks, there is never a string of the whole bitset
 std::ostream& operator<<(std::ostream& os, const RuntimeBitset& t_bitset) {
-  os << t_bitset.to_string();
+  RuntimeBitset::writeText(os, t_bitset);
   return os;
 }
 
 std::istream& operator>>(std::istream& is, RuntimeBitset& t_bitset) {
-  std::string aux;
-  is >> aux;
-  t_bitset.buildFromString(aux);
-
+  switch (RuntimeBitset::textFormat(is)) {
+    case RuntimeBitset::HEX_FORMAT: t_bitset.readDigits(is, 4, RuntimeBitset::hexTable()); break;
+    case RuntimeBitset::BASE64_FORMAT: t_bitset.readDigits(is, 6, RuntimeBitset::base64Table()); break;
+    default: t_bitset.readDigits(is, 1, RuntimeBitset::binaryTable());
+  }
   return is;
 }
 
+// The views are not materialized, their blocks are computed while they are written
+std::ostream& operator<<(std::ostream& os, const RuntimeBitset::ComplementView& t_view) {
+  RuntimeBitset::writeText(os, t_view);
+  return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const RuntimeBitset::ShiftView& t_view) {
+  RuntimeBitset::writeText(os, t_view);
+  return os;
+}
+
+std::ios_base& binaryFormat(std::ios_base& t_stream) {
+  RuntimeBitset::textFormat(t_stream) = RuntimeBitset::BINARY_FORMAT;
+  return t_stream;
+}
+
+std::ios_base& hexFormat(std::ios_base& t_stream) {
+  RuntimeBitset::textFormat(t_stream) = RuntimeBitset::HEX_FORMAT;
+  return t_stream;
+}
+
+std::ios_base& base64Format(std::ios_base& t_stream) {
+  RuntimeBitset::textFormat(t_stream) = RuntimeBitset::BASE64_FORMAT;
+  return t_stream;
+}
+
 }
 
 
@@ -231,7 +908,10 @@ RunBitset::RuntimeBitset::RuntimeBitset(const std::size_t t_size, const std::siz
 
 RunBitset::RuntimeBitset::RuntimeBitset(const std::size_t t_size) {
   build(t_size);
-  clean();
+}
+
+RunBitset::RuntimeBitset::RuntimeBitset(const std::size_t t_size, uninitialized_t) {
+  build(t_size, false);
 }
 
 RunBitset::RuntimeBitset::RuntimeBitset(const std::string& t_string) {
@@ -240,14 +920,14 @@ RunBitset::RuntimeBitset::RuntimeBitset(const std::string& t_string) {
 
 RunBitset::RuntimeBitset::RuntimeBitset() {
   build(BLOCK_SIZE);
-  clean();
 }
 
 RunBitset::RuntimeBitset::~RuntimeBitset() {
   destroy();
 }
 
-RunBitset::RuntimeBitset::RuntimeBitset(const RuntimeBitset& t_RuntimeBitset) {
+RunBitset::RuntimeBitset::RuntimeBitset(const RuntimeBitset& t_RuntimeBitset) 
+: m_countCached(t_RuntimeBitset.m_countCached), m_hasSummary(t_RuntimeBitset.m_hasSummary) {
   copy(*this, t_RuntimeBitset);
 }
 
@@ -256,7 +936,8 @@ RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::operator=(const RuntimeBitse
   return *this;
 }
 
-RunBitset::RuntimeBitset::RuntimeBitset(RuntimeBitset&& t_RuntimeBitset) {
+RunBitset::RuntimeBitset::RuntimeBitset(RuntimeBitset&& t_RuntimeBitset) 
+: m_countCached(t_RuntimeBitset.m_countCached), m_hasSummary(t_RuntimeBitset.m_hasSummary) {
   move(*this, t_RuntimeBitset);
 }
 
@@ -269,8 +950,8 @@ std::string RunBitset::RuntimeBitset::to_string() const noexcept {
   std::string toReturn;
   for (long long i = m_blocks - 1; i >= 0; --i) {
     std::stringstream buffer; // Auxiliar buffer, pending of improving
-    std::size_t block = m_bits[i] & m_mask[i];
-    std::size_t mask = m_mask[i];
+    std::size_t block = m_bits[i] & getMask(i);
+    std::size_t mask = getMask(i);
     for (std::size_t j = 0; j < BLOCK_SIZE; ++j) {
       if (mask % 2 != 0) { // Check the less significant bit of each block
         if (block % 2 != 0) {
@@ -291,44 +972,317 @@ std::string RunBitset::RuntimeBitset::to_string() const noexcept {
   return toReturn;
 }
 
-void RunBitset::RuntimeBitset::build(const std::size_t t_size) {
+void RunBitset::RuntimeBitset::build(const std::size_t t_size, const bool t_zeroed) {
   // Bitsets of size 0 breaks the implementation
   if (t_size == 0) throw (RunBitsetException::RuntimeBitsetInvalidSize());
+  // The new blocks are not shared with anyone, but the bitset is still copy on write
+  const bool copyOnWrite = isCopyOnWrite();
+  const bool threadSafe = copyOnWrite && m_shared->threadSafe;
   destroy();
   m_size = t_size;
   // Get the minimal number of blocks needed to represent the numbe of bits
   m_blocks = getNumberBlocks(t_size);
-  buildBlocks();
+  buildBlocks(t_zeroed);
+  buildMask();
+  if (copyOnWrite) m_shared = new SharedBlocks{1, threadSafe};
+  markAllDirty();
+}
+
+void RunBitset::RuntimeBitset::adoptBlocks(std::size_t* t_blocks, const std::size_t t_size) {
+  assert(t_size != 0);
+  // The only allocation, before the bitset is modified
+  SharedBlocks* shared = isCopyOnWrite() ? new SharedBlocks{1, m_shared->threadSafe} : nullptr;
+  destroy();
+  m_size = t_size;
+  m_blocks = getNumberBlocks(t_size);
+  m_bits = t_blocks;
+  m_mappedBytes = 0; // from malloc, released with free
   buildMask();
+  m_shared = shared;
 }
 
+// A division, the construction of a big bitset must not depend on its size
 std::size_t RunBitset::RuntimeBitset::getNumberBlocks(const std::size_t t_size) noexcept {
   assert (t_size != 0);
-  std::size_t numberOfBlocks = 0;
-  for (std::size_t i = 0; i < t_size; i+=BLOCK_SIZE) {
-    ++numberOfBlocks;
+  return t_size / BLOCK_SIZE + ((t_size % BLOCK_SIZE != 0) ? 1 : 0);
+}
+
+// calloc instead of new + clean: for big bitsets the OS gives pages already at 0, 
+//   and they are not touched until they are used, so the construction is almost free
+void RunBitset::RuntimeBitset::buildBlocks(const bool t_zeroed) {
+  const std::size_t bytes = m_blocks * sizeof(std::size_t);
+  m_mappedBytes = 0;
+  if (bytes >= getHugePageThreshold()) {
+    m_bits = mapHugePages(bytes); // the mapping is always 0
+    if (m_bits != nullptr) return;
+  }
+  void* memory = t_zeroed 
+    ? std::calloc(m_blocks, sizeof(std::size_t)) 
+    : std::malloc(m_blocks * sizeof(std::size_t));
+  if (memory == nullptr) throw(std::bad_alloc());
+  m_bits = static_cast<std::size_t*>(memory);
+}
+
+std::size_t* RunBitset::RuntimeBitset::mapHugePages(const std::size_t t_bytes) noexcept {
+#if defined(__linux__)
+  const std::size_t length = (t_bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#if defined(RUNBITSET_USE_HUGETLB) && defined(MAP_HUGETLB)
+  void* hugetlb = mmap(nullptr, length, PROT_READ | PROT_WRITE, 
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (hugetlb != MAP_FAILED) {
+    m_mappedBytes = length;
+    return static_cast<std::size_t*>(hugetlb);
   }
-  return numberOfBlocks;
+  // There are no reserved huge pages, try with transparent huge pages
+#endif
+  // One huge page more, so the start can be aligned
+  void* memory = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, 
+    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) return nullptr;
+  const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(memory);
+  const std::uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~static_cast<std::uintptr_t>(HUGE_PAGE_SIZE - 1);
+  // Give back the parts before and after the aligned region
+  if (aligned != start) munmap(memory, aligned - start);
+  const std::size_t tail = (start + length + HUGE_PAGE_SIZE) - (aligned + length);
+  if (tail != 0) munmap(reinterpret_cast<void*>(aligned + length), tail);
+#if defined(MADV_HUGEPAGE)
+  madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE); // only a hint, it can fail
+#endif
+  m_mappedBytes = length;
+  return reinterpret_cast<std::size_t*>(aligned);
+#else
+  (void)t_bytes;
+  return nullptr;
+#endif
 }
 
-void RunBitset::RuntimeBitset::buildBlocks() {
-  m_bits = new std::size_t[m_blocks];
-  m_mask = new std::size_t[m_blocks];
+void RunBitset::RuntimeBitset::releaseBlocks
+(std::size_t* t_bits, [[maybe_unused]] const std::size_t t_mappedBytes) noexcept {
+#if defined(__linux__)
+  if (t_mappedBytes != 0) {
+    munmap(t_bits, t_mappedBytes);
+    return;
+  }
+#endif
+  std::free(t_bits);
 }
 
-void RunBitset::RuntimeBitset::buildMask() {
-  for (std::size_t i = 0; i < m_blocks; ++i) {
-    m_mask[i] = ALL_BITS_ONE;
+// Without t_threadSafe the counter is only modified by one thread, no need of atomics
+void RunBitset::RuntimeBitset::addReference(SharedBlocks* t_shared) noexcept {
+  if (t_shared->threadSafe) {
+    std::atomic_ref<std::size_t>(t_shared->references).fetch_add(1, std::memory_order_relaxed);
+  }
+  else {
+    ++t_shared->references;
+  }
+}
+
+// acq_rel: the writes of the other owners must be visible before the blocks are freed
+bool RunBitset::RuntimeBitset::removeReference(SharedBlocks* t_shared) noexcept {
+  std::size_t remaining = 0;
+  if (t_shared->threadSafe) {
+    remaining = std::atomic_ref<std::size_t>(t_shared->references).fetch_sub(1, std::memory_order_acq_rel) - 1;
+  }
+  else {
+    remaining = --t_shared->references;
+  }
+  if (remaining != 0) return false;
+  delete t_shared;
+  return true;
+}
+
+std::size_t RunBitset::RuntimeBitset::getReferences(SharedBlocks* t_shared) noexcept {
+  if (t_shared->threadSafe) {
+    return std::atomic_ref<std::size_t>(t_shared->references).load(std::memory_order_acquire);
+  }
+  return t_shared->references;
+}
+
+void RunBitset::RuntimeBitset::detach() {
+  if (m_shared == nullptr || getReferences(m_shared) == 1) return;
+  SharedBlocks* shared = new SharedBlocks{1, m_shared->threadSafe};
+  std::size_t* oldBits = m_bits;
+  const std::size_t oldMappedBytes = m_mappedBytes;
+  try {
+    buildBlocks(false); // all the blocks are copied
+  }
+  catch (...) {
+    m_bits = oldBits;
+    m_mappedBytes = oldMappedBytes;
+    delete shared;
+    throw;
+  }
+  std::memcpy(m_bits, oldBits, m_blocks * sizeof(std::size_t));
+  // The other owners could have released them meanwhile
+  if (removeReference(m_shared)) releaseBlocks(oldBits, oldMappedBytes);
+  m_shared = shared;
+}
+
+void RunBitset::RuntimeBitset::enableCopyOnWrite(const bool t_threadSafe) {
+  if (m_shared == nullptr) {
+    m_shared = new SharedBlocks{1, t_threadSafe};
+    return;
+  }
+  // Changing the counter mode is only possible if nobody else is using it
+  detach();
+  m_shared->threadSafe = t_threadSafe;
+}
+
+void RunBitset::RuntimeBitset::disableCopyOnWrite() {
+  if (m_shared == nullptr) return;
+  detach(); // now the blocks are only of this bitset
+  delete m_shared;
+  m_shared = nullptr;
+}
+
+bool RunBitset::RuntimeBitset::isShared() const noexcept {
+  return m_shared != nullptr && getReferences(m_shared) > 1;
+}
+
+void RunBitset::RuntimeBitset::enableDirtyTracking(const bool t_journal) {
+  m_journaled = t_journal;
+  if (!t_journal) clearJournal();
+  if (m_dirtyTracked) return;
+  const std::size_t pages = (m_blocks + DIRTY_PAGE_BLOCKS - 1) / DIRTY_PAGE_BLOCKS;
+  m_dirty.assign(getNumberBlocks(pages), 0); // one bit per page
+  m_dirtyTracked = true;
+}
+
+void RunBitset::RuntimeBitset::disableDirtyTracking() noexcept {
+  m_dirtyTracked = false;
+  m_journaled = false;
+  m_dirty.clear();
+  m_dirty.shrink_to_fit();
+  clearJournal();
+}
+
+std::vector<std::pair<std::size_t, std::size_t>> RunBitset::RuntimeBitset::dirtyRanges() const {
+  std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  for (std::size_t w = 0; w < m_dirty.size(); ++w) {
+    for (std::size_t word = m_dirty[w]; word != 0; word &= word - 1) {
+      const std::size_t page = w * BLOCK_SIZE + std::countr_zero(word);
+      const std::size_t first = page * DIRTY_PAGE_BLOCKS;
+      const std::size_t last = std::min(first + DIRTY_PAGE_BLOCKS, m_blocks);
+      // Consecutive pages are only one range
+      if (!ranges.empty() && ranges.back().second == first) ranges.back().second = last;
+      else ranges.emplace_back(first, last);
+    }
+  }
+  return ranges;
+}
+
+void RunBitset::RuntimeBitset::clearDirty() noexcept {
+  std::fill(m_dirty.begin(), m_dirty.end(), 0);
+}
+
+void RunBitset::RuntimeBitset::clearJournal() noexcept {
+  m_journal.clear();
+}
+
+void RunBitset::RuntimeBitset::markDirty(const std::size_t t_block) {
+  const std::size_t page = t_block / DIRTY_PAGE_BLOCKS;
+  m_dirty[page / BLOCK_SIZE] |= getMaskPosition(page % BLOCK_SIZE);
+  if (m_journaled) m_journal.push_back({t_block, m_bits[t_block] & getMask(t_block)});
+}
+
+void RunBitset::RuntimeBitset::markDirty(const std::size_t t_first, const std::size_t t_last) {
+  if (!m_dirtyTracked) return;
+  for (std::size_t page = t_first / DIRTY_PAGE_BLOCKS; page * DIRTY_PAGE_BLOCKS < t_last; ++page) {
+    m_dirty[page / BLOCK_SIZE] |= getMaskPosition(page % BLOCK_SIZE);
+  }
+  if (!m_journaled) return;
+  for (std::size_t i = t_first; i < t_last; ++i) {
+    m_journal.push_back({i, m_bits[i] & getMask(i)});
+  }
+}
+
+void RunBitset::RuntimeBitset::reserveDirty(const std::size_t t_blocks) {
+  if (!m_dirtyTracked) return;
+  const std::size_t pages = (t_blocks + DIRTY_PAGE_BLOCKS - 1) / DIRTY_PAGE_BLOCKS;
+  m_dirty.reserve(getNumberBlocks(pages));
+  if (m_journaled) m_journal.reserve(m_journal.size() + t_blocks);
+}
+
+void RunBitset::RuntimeBitset::markAllDirty() {
+  if (!m_dirtyTracked) return;
+  const std::size_t pages = (m_blocks + DIRTY_PAGE_BLOCKS - 1) / DIRTY_PAGE_BLOCKS;
+  m_dirty.assign(getNumberBlocks(pages), 0);
+  markDirty(0, m_blocks);
+}
+
+void RunBitset::RuntimeBitset::setHugePageThreshold(const std::size_t t_bytes) noexcept {
+  s_hugePageThreshold.store(t_bytes, std::memory_order_relaxed);
+}
+
+std::size_t RunBitset::RuntimeBitset::getHugePageThreshold() noexcept {
+  return s_hugePageThreshold.load(std::memory_order_relaxed);
+}
+
+void RunBitset::RuntimeBitset::setStreamingThreshold(const std::size_t t_bytes) noexcept {
+  s_streamingThreshold.store(t_bytes, std::memory_order_relaxed);
+}
+
+std::size_t RunBitset::RuntimeBitset::getStreamingThreshold() noexcept {
+  return s_streamingThreshold.load(std::memory_order_relaxed);
+}
+
+template <typename Function, typename Prefetch>
+void RunBitset::RuntimeBitset::writeBlocks(std::size_t* t_destination, const std::size_t t_blocks, 
+  Function t_block, [[maybe_unused]] Prefetch t_prefetch) noexcept {
+  std::size_t i = 0;
+#if defined(RUNBITSET_STREAMING_STORES)
+  if (t_blocks * sizeof(std::size_t) >= getStreamingThreshold()) {
+    // Normal stores until the destination is aligned to 16 bytes
+    for (; i < t_blocks && reinterpret_cast<std::uintptr_t>(t_destination + i) % 16 != 0; ++i) {
+      t_destination[i] = t_block(i);
+    }
+    // i is odd after the prologue if the destination is 8 mod 16, so the next prefetch has its own counter
+    std::size_t nextPrefetch = i;
+    for (; i + 1 < t_blocks; i += 2) {
+      if (i >= nextPrefetch) {
+        t_prefetch(i);
+        nextPrefetch = i + BLOCKS_PER_LINE;
+      }
+      const __m128i value = _mm_set_epi64x(static_cast<long long>(t_block(i + 1)), 
+        static_cast<long long>(t_block(i)));
+      _mm_stream_si128(reinterpret_cast<__m128i*>(t_destination + i), value);
+    }
+    // The streaming stores are not ordered with the rest, sfence before anyone reads them
+    _mm_sfence();
+  }
+#endif
+  for (; i < t_blocks; ++i) {
+    t_destination[i] = t_block(i);
   }
+}
+
+template <typename Function>
+void RunBitset::RuntimeBitset::writeBlocks(std::size_t* t_destination, const std::size_t t_blocks, 
+  Function t_block) noexcept {
+  writeBlocks(t_destination, t_blocks, t_block, [](std::size_t) {});
+}
+
+void RunBitset::RuntimeBitset::prefetchBlock
+([[maybe_unused]] const RuntimeBitset& t_bitset, [[maybe_unused]] const std::size_t t_block) noexcept {
+#if defined(__GNUC__)
+  if (t_block + PREFETCH_DISTANCE < t_bitset.m_blocks) {
+    __builtin_prefetch(t_bitset.m_bits + t_block + PREFETCH_DISTANCE);
+  }
+#endif
+}
+
+void RunBitset::RuntimeBitset::buildMask() {
   std::size_t lastMask = m_size - ((m_blocks -1) * BLOCK_SIZE);
   // Only the most significant block has a no ~0 mask
-  m_mask[m_blocks - 1] = getLastMask(lastMask);
+  m_lastMask = getLastMask(lastMask);
+}
+
+std::size_t RunBitset::RuntimeBitset::getMask(const std::size_t t_block) const noexcept {
+  return (t_block == m_blocks - 1) ? m_lastMask : ALL_BITS_ONE;
 }
 
 void RunBitset::RuntimeBitset::clean() {
-  for (std::size_t i = 0; i < m_blocks; ++i) {
-    m_bits[i] = 0;
-  }
+  writeBlocks(m_bits, m_blocks, [](std::size_t) -> std::size_t {return 0;});
 }
 
 std::size_t RunBitset::RuntimeBitset::getLastMask(const std::size_t t_number_bits) {
@@ -339,25 +1293,93 @@ std::size_t RunBitset::RuntimeBitset::getLastMask(const std::size_t t_number_bit
 
 void RunBitset::RuntimeBitset::destroy() {
   if (m_bits != nullptr) { // Avoid double deletion
-    delete[] m_bits;
+    // Shared blocks are only freed by the last owner
+    if (m_shared == nullptr || removeReference(m_shared)) releaseBlocks(m_bits, m_mappedBytes);
     m_bits = nullptr;
+    m_mappedBytes = 0;
   }
-  if (m_mask != nullptr) { // Avoid double deletion
-    delete[] m_mask;
-    m_mask = nullptr;
-  }
+  m_shared = nullptr;
   m_size = 0;
   m_blocks = 0;
 }
 
+// If t_toCopy is copy on write, the blocks are shared
+// If t_copy already has the same number of blocks, its blocks are reused
+// If not, the copy is built apart and then exchanged
+// All the allocations are done before t_copy is modified, so if one fails t_copy is not modified
 void RunBitset::RuntimeBitset::copy
 (RuntimeBitset& t_copy, const RuntimeBitset& t_toCopy) {
-  t_copy.destroy();
-  t_copy.build(t_toCopy.size()); // bitset of same size as t_toCopy
-  for (std::size_t i = 0; i < t_copy.m_blocks; ++i) {
-    const std::size_t blockToCopy = t_toCopy.m_bits[i]; // copy all the blocks
-    t_copy.m_bits[i] = blockToCopy;
+  if (&t_copy == &t_toCopy) return;
+  if (t_toCopy.m_shared != nullptr) {
+    std::vector<std::vector<std::size_t>> summary = reserveModes(t_copy, t_toCopy);
+    if (t_copy.m_shared != t_toCopy.m_shared) {
+      addReference(t_toCopy.m_shared);
+      t_copy.destroy();
+      t_copy.m_bits = t_toCopy.m_bits;
+      t_copy.m_mappedBytes = t_toCopy.m_mappedBytes;
+      t_copy.m_shared = t_toCopy.m_shared;
+      t_copy.m_size = t_toCopy.m_size;
+      t_copy.m_blocks = t_toCopy.m_blocks;
+      t_copy.m_lastMask = t_toCopy.m_lastMask;
+    }
+    copyModes(t_copy, t_toCopy, summary);
+    t_copy.markAllDirty();
+    return;
+  }
+  // The shared blocks can´t be reused, and a copy of a normal bitset is not copy on write
+  // They are released by aux after the swap, once nothing else can fail
+  if (t_copy.m_shared != nullptr || t_copy.m_bits == nullptr || t_copy.m_blocks != t_toCopy.m_blocks) {
+    RuntimeBitset aux(t_toCopy.size(), uninitialized);
+    aux.m_countCached = t_copy.m_countCached;
+    aux.m_hasSummary = t_copy.m_hasSummary;
+    copy(aux, t_toCopy); // same number of blocks
+    t_copy.reserveDirty(aux.m_blocks); // aux already has the summary
+    t_copy.swap(aux); // aux has the old blocks now, they are freed with it
+    t_copy.markAllDirty();
+    return;
   }
+  std::vector<std::vector<std::size_t>> summary = reserveModes(t_copy, t_toCopy);
+  t_copy.m_size = t_toCopy.m_size;
+  t_copy.m_lastMask = t_toCopy.m_lastMask;
+  // memcpy is already vectorized, and for big copies it uses non temporal stores by itself
+  std::memcpy(t_copy.m_bits, t_toCopy.m_bits, t_copy.m_blocks * sizeof(std::size_t));
+  copyModes(t_copy, t_toCopy, summary);
+  t_copy.markAllDirty();
+}
+
+// The summary is copied (or its levels allocated) here, the dirty pages and the journal are reserved
+std::vector<std::vector<std::size_t>> 
+RunBitset::RuntimeBitset::reserveModes(RuntimeBitset& t_copy, const RuntimeBitset& t_toCopy) {
+  std::vector<std::vector<std::size_t>> summary;
+  if (t_copy.m_hasSummary) {
+    summary = t_toCopy.m_hasSummary ? t_toCopy.m_summary : emptySummary(t_toCopy.m_blocks);
+  }
+  t_copy.reserveDirty(t_toCopy.m_blocks);
+  return summary;
+}
+
+// The cache and summary modes belong to t_copy, assignment doesn´t change them
+// The summary levels already have their size, rebuildSummary doesn´t allocate
+void RunBitset::RuntimeBitset::copyModes(RuntimeBitset& t_copy, const RuntimeBitset& t_toCopy, 
+  std::vector<std::vector<std::size_t>>& t_summary) {
+  if (t_copy.m_countCached) t_copy.m_count = t_toCopy.count();
+  if (t_copy.m_hasSummary) {
+    t_copy.m_summary.swap(t_summary);
+    if (!t_toCopy.m_hasSummary) t_copy.rebuildSummary();
+  }
+}
+
+void RunBitset::RuntimeBitset::swap(RuntimeBitset& t_other) noexcept {
+  std::swap(m_bits, t_other.m_bits);
+  std::swap(m_lastMask, t_other.m_lastMask);
+  std::swap(m_mappedBytes, t_other.m_mappedBytes);
+  std::swap(m_size, t_other.m_size);
+  std::swap(m_blocks, t_other.m_blocks);
+  std::swap(m_countCached, t_other.m_countCached);
+  std::swap(m_count, t_other.m_count);
+  std::swap(m_hasSummary, t_other.m_hasSummary);
+  std::swap(m_summary, t_other.m_summary);
+  std::swap(m_shared, t_other.m_shared);
 }
 
 void RunBitset::RuntimeBitset::move
@@ -365,26 +1387,37 @@ void RunBitset::RuntimeBitset::move
   t_move.destroy();
   // MOVE
   t_move.m_bits = t_toMove.m_bits;
-  t_move.m_mask = t_toMove.m_mask;
+  t_move.m_lastMask = t_toMove.m_lastMask;
+  t_move.m_mappedBytes = t_toMove.m_mappedBytes;
+  t_move.m_shared = t_toMove.m_shared;
   t_move.m_size = t_toMove.m_size;
   t_move.m_blocks = t_toMove.m_blocks;
+  if (t_move.m_countCached) t_move.m_count = t_toMove.count();
+  if (t_move.m_hasSummary) {
+    if (t_toMove.m_hasSummary) t_move.m_summary = std::move(t_toMove.m_summary);
+    else t_move.rebuildSummary();
+  }
+  t_move.markAllDirty();
   // CLEAN
   t_toMove.m_bits = nullptr;
-  t_toMove.m_mask = nullptr;
+  t_toMove.m_mappedBytes = 0;
+  t_toMove.m_shared = nullptr;
   t_toMove.m_size = 0;
   t_toMove.m_blocks = 0;
   t_toMove.build(1);
+  t_toMove.m_count = 0;
+  if (t_toMove.m_hasSummary) t_toMove.rebuildSummary();
 }
 
 unsigned long long RunBitset::RuntimeBitset::to_ullong() const noexcept {
-  std::size_t bits = m_bits[0] & m_mask[0]; // Aply mask to avoid useless bits
+  std::size_t bits = m_bits[0] & getMask(0); // Aply mask to avoid useless bits
   // return the less significant <sizeof(ullong) * 8 bits> of the less significant block
   return static_cast<unsigned long long>(bits);
 
 }
 
 unsigned long RunBitset::RuntimeBitset::to_ulong() const noexcept {
-  std::size_t bits = m_bits[0] & m_mask[0];// Aply mask to avoid useless bits
+  std::size_t bits = m_bits[0] & getMask(0);// Aply mask to avoid useless bits
   // return the less significant <sizeof(ulong) * 8 bits> of the less significant block
   return static_cast<unsigned long>(bits);
 }
@@ -392,23 +1425,26 @@ unsigned long RunBitset::RuntimeBitset::to_ulong() const noexcept {
 bool RunBitset::RuntimeBitset::all() const noexcept {
   for ( std::size_t i = 0; i < m_blocks; ++i) {
     // If applying the mask is equal to mask, then it is true
-    if ((m_bits[i] & m_mask[i]) != m_mask[i]) return false;
+    if ((m_bits[i] & getMask(i)) != getMask(i)) return false;
   }
   return true;
 }
 
 bool RunBitset::RuntimeBitset::any() const noexcept {
+  // The last level of the summary is only one word
+  if (m_hasSummary) return m_summary.back()[0] != 0;
   for (std::size_t i = 0; i < m_blocks; ++i) {
     // If applying the mask is not 0, then atleast 1 bit is set
-    if ((m_bits[i] & m_mask[i]) != 0) return true;
+    if ((m_bits[i] & getMask(i)) != 0) return true;
   }
   return false;
 }
 
 bool RunBitset::RuntimeBitset::none() const noexcept {
+  if (m_hasSummary) return m_summary.back()[0] == 0;
   for (std::size_t i = 0; i < m_blocks; ++i) {
     // exactly the opposite to any
-    if ((m_bits[i] & m_mask[i]) != 0) return false;
+    if ((m_bits[i] & getMask(i)) != 0) return false;
   }
   return true;
 }
@@ -418,13 +1454,8 @@ bool RunBitset::RuntimeBitset::none() const noexcept {
 std::pair<std::size_t, std::size_t> 
 RunBitset::RuntimeBitset::getPosition(std::size_t t_position) const {
   if (t_position >= m_size) throw(RunBitsetException::RuntimeBitsetOutOfRange());
-  std::size_t blockPosition = 0;
-  // Get in what block is allocated
-  while (t_position >= BLOCK_SIZE) {
-    t_position -= BLOCK_SIZE; // get internal block position
-    ++blockPosition;
-  }
-  return std::make_pair(blockPosition, getMaskPosition(t_position));
+  // Block where it is allocated, and internal block position
+  return std::make_pair(t_position / BLOCK_SIZE, getMaskPosition(t_position % BLOCK_SIZE));
 }
 
 /// Returns a mask with all 0 except in the t_position
@@ -434,43 +1465,62 @@ std::size_t RunBitset::RuntimeBitset::getMaskPosition(const std::size_t t_positi
   return (auxMask << t_position);
 }
 
-RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::set() noexcept {
-  for (std::size_t i = 0; i < m_blocks; ++i) {
-    m_bits[i] = ALL_BITS_ONE;
-  }
+RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::set() {
+  detach();
+  writeBlocks(m_bits, m_blocks, [](std::size_t) {return ALL_BITS_ONE;});
+  m_count = m_size;
+  rebuildSummary();
+  markDirty(0, m_blocks);
   return *this;
 }
 
 RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::set(const std::size_t t_position) {
   const std::pair<std::size_t, std::size_t> position(getPosition(t_position));
+  detach();
   const std::size_t blockPosition = position.first;
   const std::size_t positionMask = position.second;
+  if (m_countCached && (m_bits[blockPosition] & positionMask) == 0) ++m_count;
   m_bits[blockPosition] |= positionMask; // will apply X | 1 in the position, the rest X | 0
+  if (m_hasSummary) updateSummary(blockPosition);
+  if (m_dirtyTracked) markDirty(blockPosition);
   return *this;
 }
 
-RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::reset() noexcept {
+RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::reset() {
+  detach();
   clean();
+  m_count = 0;
+  rebuildSummary();
+  markDirty(0, m_blocks);
   return *this;
 }
 
 RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::reset(const std::size_t t_position) {
   const std::pair<std::size_t, std::size_t> position(getPosition(t_position));
+  detach();
   const std::size_t blockPosition = position.first;
   const std::size_t positionMask = ~position.second; // Reversed position mask
+  if (m_countCached && (m_bits[blockPosition] & position.second) != 0) --m_count;
   m_bits[blockPosition] &= positionMask; // will aply X & 0 in the position, the rest X & 1
+  if (m_hasSummary) updateSummary(blockPosition);
+  if (m_dirtyTracked) markDirty(blockPosition);
   return *this;
 }
 
-RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::flip() noexcept {
+RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::flip() {
+  detach();
   for (std::size_t i = 0; i < m_blocks; ++i) {
     m_bits[i] = ~m_bits[i];
   }
+  m_count = m_size - m_count;
+  rebuildSummary();
+  markDirty(0, m_blocks);
   return *this;
 }
 
 RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::flip(const std::size_t t_position) {
   const std::pair<std::size_t, std::size_t> position(getPosition(t_position));
+  detach();
   const std::size_t blockPosition = position.first;
   const std::size_t positionMask = position.second;
 
@@ -481,6 +1531,12 @@ RunBitset::RuntimeBitset& RunBitset::RuntimeBitset::flip(const std::size_t t_pos
   const std::size_t allExceptPositionValue = m_bits[blockPosition] & ~positionMask;
   // example: 000R000 | XXX0XXX
   m_bits[blockPosition] = allExceptPositionValue | positionValueReversed;
+  if (m_countCached) {
+    if (positionValueReversed != 0) ++m_count;
+    else --m_count;
+  }
+  if (m_hasSummary) updateSummary(blockPosition);
+  if (m_dirtyTracked) markDirty(blockPosition);
   return *this;
 }
 
@@ -489,85 +1545,406 @@ void RunBitset::RuntimeBitset::printDebug() const noexcept {
 }
 
 std::size_t RunBitset::RuntimeBitset::count() const noexcept {
+  if (m_countCached) return m_count;
+  return countBlocks();
+}
+
+std::size_t RunBitset::RuntimeBitset::countBlocks() const noexcept {
   std::size_t numberOfActive = 0;
-  for (std::size_t i = 0; i < m_blocks; ++i) {
-    std::size_t block = m_bits[i] & m_mask[i]; // apply mask; remove no significant bits
-    for (std::size_t j = 0; j < BLOCK_SIZE; ++j) {
-      if (block % 2 != 0) ++numberOfActive; // check less significant bit
-      block >>= 1;
+  if (m_hasSummary) { // only the blocks with active bits
+    for (std::size_t i = nextActiveBlock(0); i < m_blocks; i = nextActiveBlock(i + 1)) {
+      numberOfActive += std::popcount(m_bits[i] & getMask(i));
     }
+    return numberOfActive;
+  }
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    // apply mask; remove no significant bits
+    numberOfActive += std::popcount(m_bits[i] & getMask(i));
   }
   return numberOfActive;
 }
 
-bool RunBitset::RuntimeBitset::operator[](std::size_t t_position) const {
-  return getValueInPosition(t_position);
+void RunBitset::RuntimeBitset::recount() noexcept {
+  if (m_countCached) m_count = countBlocks();
 }
 
-bool RunBitset::RuntimeBitset::test(std::size_t t_position) const {
-  return getValueInPosition(t_position);
+void RunBitset::RuntimeBitset::enableCountCache() noexcept {
+  if (m_countCached) return;
+  m_count = countBlocks();
+  m_countCached = true;
 }
 
-bool RunBitset::RuntimeBitset::getValueInPosition(std::size_t t_position) const {
-  const std::pair<std::size_t, std::size_t> position(getPosition(t_position));
-  const std::size_t blockPosition = position.first;
-  const std::size_t positionMask = position.second;
-  
-  // Get all 0 and the value in t_position
-  const std::size_t auxBlock = m_bits[blockPosition] & positionMask;
-  if ((auxBlock | 0) == 0) return false; // if BXB | 0 == 0, then X = 0
-  return true;
+void RunBitset::RuntimeBitset::disableCountCache() noexcept {
+  m_countCached = false;
 }
 
-RunBitset::RuntimeBitset& 
-RunBitset::RuntimeBitset::operator&=(const RuntimeBitset& t_other) {
-  *this = *this & t_other;
-  return *this;
+std::size_t RunBitset::RuntimeBitset::find_first() const noexcept {
+  return find_next(0);
 }
 
-RunBitset::RuntimeBitset& 
-RunBitset::RuntimeBitset::operator|=(const RuntimeBitset& t_other) {
-  *this = *this | t_other;
-  return *this;
+std::size_t RunBitset::RuntimeBitset::find_next(const std::size_t t_position) const noexcept {
+  if (t_position >= m_size) return m_size;
+  std::size_t block = t_position / BLOCK_SIZE;
+  // Rest of the block of t_position
+  const std::size_t first = m_bits[block] & getMask(block) & (ALL_BITS_ONE << (t_position % BLOCK_SIZE));
+  if (first != 0) return block * BLOCK_SIZE + std::countr_zero(first);
+  block = nextActiveBlock(block + 1);
+  if (block >= m_blocks) return m_size;
+  return block * BLOCK_SIZE + std::countr_zero(m_bits[block] & getMask(block));
 }
 
-RunBitset::RuntimeBitset& 
-RunBitset::RuntimeBitset::operator^=(const RuntimeBitset& t_other) {
-  *this = *this ^ t_other;
-  return *this;
+std::size_t RunBitset::RuntimeBitset::nextActiveBlock(const std::size_t t_block) const noexcept {
+  if (t_block >= m_blocks) return m_blocks;
+  if (m_hasSummary) {
+    const std::size_t block = nextInSummary(0, t_block);
+    return (block == npos) ? m_blocks : block;
+  }
+  for (std::size_t i = t_block; i < m_blocks; ++i) {
+    if ((m_bits[i] & getMask(i)) != 0) return i;
+  }
+  return m_blocks;
 }
 
-RunBitset::RuntimeBitset RunBitset::RuntimeBitset::operator~() {
-  for (std::size_t i = 0; i < this->m_blocks; ++i) {
-    // Don´t need to apply mask due it doesn´t affect the significant bits
-    m_bits[i] = ~m_bits[i];
-  }
-  return *this;
+// If the word of t_position doesn´t have more active bits, 
+//   the next level says what is the next word that has them
+std::size_t RunBitset::RuntimeBitset::nextInSummary
+(const std::size_t t_level, const std::size_t t_position) const noexcept {
+  const std::vector<std::size_t>& level = m_summary[t_level];
+  std::size_t word = t_position / BLOCK_SIZE;
+  if (word >= level.size()) return npos;
+  const std::size_t rest = level[word] & (ALL_BITS_ONE << (t_position % BLOCK_SIZE));
+  if (rest != 0) return word * BLOCK_SIZE + std::countr_zero(rest);
+  if (t_level + 1 == m_summary.size()) return npos; // the last level is only one word
+  word = nextInSummary(t_level + 1, word + 1);
+  if (word == npos) return npos;
+  return word * BLOCK_SIZE + std::countr_zero(level[word]);
 }
 
-RunBitset::RuntimeBitset 
-RunBitset::RuntimeBitset::operator<<(std::size_t t_pos) const {
-  RuntimeBitset aux = *this;
-  aux.bitwiseLeft(t_pos);
-  return aux;
+void RunBitset::RuntimeBitset::enableSummary() {
+  if (m_hasSummary) return;
+  m_hasSummary = true;
+  rebuildSummary();
 }
 
-RunBitset::RuntimeBitset 
-RunBitset::RuntimeBitset::operator>>(std::size_t t_pos) const {
-  RuntimeBitset aux = *this;
-  aux.bitwiseRight(t_pos);
-  return aux;
+void RunBitset::RuntimeBitset::disableSummary() noexcept {
+  m_hasSummary = false;
+  m_summary.clear();
+  m_summary.shrink_to_fit();
 }
 
-RunBitset::RuntimeBitset& 
-RunBitset::RuntimeBitset::operator<<=(std::size_t t_pos) {
-  this->bitwiseLeft(t_pos);
-  return *this;
+void RunBitset::RuntimeBitset::updateSummary(const std::size_t t_block) noexcept {
+  bool active = (m_bits[t_block] & getMask(t_block)) != 0;
+  std::size_t position = t_block;
+  for (std::vector<std::size_t>& level : m_summary) {
+    std::size_t& word = level[position / BLOCK_SIZE];
+    const bool wasActive = (word != 0);
+    if (active) word |= getMaskPosition(position % BLOCK_SIZE);
+    else word &= ~getMaskPosition(position % BLOCK_SIZE);
+    // The upper level only changes if the word changes from or to 0
+    if (wasActive == (word != 0)) return;
+    active = (word != 0);
+    position /= BLOCK_SIZE;
+  }
+}
+
+void RunBitset::RuntimeBitset::rebuildSummary() {
+  if (!m_hasSummary) return;
+  resetSummary();
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    if ((m_bits[i] & getMask(i)) != 0) m_summary[0][i / BLOCK_SIZE] |= getMaskPosition(i % BLOCK_SIZE);
+  }
+  buildSummaryLevels();
+}
+
+void RunBitset::RuntimeBitset::resetSummary() {
+  const std::size_t firstLevelWords = getNumberBlocks(m_blocks);
+  if (!m_summary.empty() && m_summary[0].size() == firstLevelWords) {
+    for (std::vector<std::size_t>& level : m_summary) {
+      std::fill(level.begin(), level.end(), 0);
+    }
+    return;
+  }
+  m_summary = emptySummary(m_blocks);
+}
+
+std::vector<std::vector<std::size_t>> RunBitset::RuntimeBitset::emptySummary(const std::size_t t_blocks) {
+  std::vector<std::vector<std::size_t>> summary(1, std::vector<std::size_t>(getNumberBlocks(t_blocks), 0));
+  while (summary.back().size() > 1) {
+    summary.emplace_back(getNumberBlocks(summary.back().size()), 0);
+  }
+  return summary;
+}
+
+void RunBitset::RuntimeBitset::buildSummaryLevels() noexcept {
+  for (std::size_t l = 1; l < m_summary.size(); ++l) {
+    const std::vector<std::size_t>& previous = m_summary[l - 1];
+    std::vector<std::size_t>& level = m_summary[l];
+    std::fill(level.begin(), level.end(), 0);
+    for (std::size_t i = 0; i < previous.size(); ++i) {
+      if (previous[i] != 0) level[i / BLOCK_SIZE] |= getMaskPosition(i % BLOCK_SIZE);
+    }
+  }
+}
+
+bool RunBitset::RuntimeBitset::operator[](std::size_t t_position) const {
+  return getValueInPosition(t_position);
+}
+
+bool RunBitset::RuntimeBitset::test(std::size_t t_position) const {
+  return getValueInPosition(t_position);
+}
+
+std::size_t RunBitset::RuntimeBitset::getBlock(const std::size_t t_block) const {
+  if (t_block >= m_blocks) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  return m_bits[t_block] & getMask(t_block);
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::setBlock(const std::size_t t_block, const std::size_t t_value) {
+  if (t_block >= m_blocks) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  const std::size_t value = t_value & getMask(t_block);
+  detach();
+  if (m_countCached) {
+    m_count -= std::popcount(m_bits[t_block] & getMask(t_block));
+    m_count += std::popcount(value);
+  }
+  m_bits[t_block] = value;
+  if (m_hasSummary) updateSummary(t_block);
+  if (m_dirtyTracked) markDirty(t_block);
+  return *this;
+}
+
+bool RunBitset::RuntimeBitset::getValueInPosition(std::size_t t_position) const {
+  const std::pair<std::size_t, std::size_t> position(getPosition(t_position));
+  const std::size_t blockPosition = position.first;
+  const std::size_t positionMask = position.second;
+  
+  // Get all 0 and the value in t_position
+  const std::size_t auxBlock = m_bits[blockPosition] & positionMask;
+  if ((auxBlock | 0) == 0) return false; // if BXB | 0 == 0, then X = 0
+  return true;
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::operator&=(const RuntimeBitset& t_other) {
+  applyOperation(t_other, [](std::size_t t_a, std::size_t t_b) {return t_a & t_b;});
+  return *this;
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::operator|=(const RuntimeBitset& t_other) {
+  applyOperation(t_other, [](std::size_t t_a, std::size_t t_b) {return t_a | t_b;});
+  return *this;
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::operator^=(const RuntimeBitset& t_other) {
+  applyOperation(t_other, [](std::size_t t_a, std::size_t t_b) {return t_a ^ t_b;});
+  return *this;
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::operator&=(const ShiftView& t_other) {
+  applyOperation(t_other, [](std::size_t t_a, std::size_t t_b) {return t_a & t_b;});
+  return *this;
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::operator|=(const ShiftView& t_other) {
+  applyOperation(t_other, [](std::size_t t_a, std::size_t t_b) {return t_a | t_b;});
+  return *this;
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::operator^=(const ShiftView& t_other) {
+  applyOperation(t_other, [](std::size_t t_a, std::size_t t_b) {return t_a ^ t_b;});
+  return *this;
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::operator&=(const ComplementView& t_other) {
+  applyOperation(t_other.m_bitset, [](std::size_t t_a, std::size_t t_b) {return t_a & ~t_b;});
+  return *this;
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::operator|=(const ComplementView& t_other) {
+  applyOperation(t_other.m_bitset, [](std::size_t t_a, std::size_t t_b) {return t_a | ~t_b;});
+  return *this;
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::operator^=(const ComplementView& t_other) {
+  applyOperation(t_other.m_bitset, [](std::size_t t_a, std::size_t t_b) {return ~(t_a ^ t_b);});
+  return *this;
+}
+
+RunBitset::RuntimeBitset::ComplementView RunBitset::RuntimeBitset::operator~() const& noexcept {
+  return ComplementView(*this);
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::operator~() && {
+  flip();
+  return std::move(*this);
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::operator~() const&& {
+  return ComplementView(*this);
+}
+
+std::size_t RunBitset::RuntimeBitset::readBlock
+(const RuntimeBitset& t_bitset, const std::size_t t_block) noexcept {
+  return t_bitset.m_bits[t_block];
+}
+
+std::size_t RunBitset::RuntimeBitset::readBlock
+(const ShiftView& t_view, const std::size_t t_block) noexcept {
+  return t_view.getBlock(t_block);
+}
+
+std::size_t RunBitset::RuntimeBitset::readBlock
+(const ComplementView& t_view, const std::size_t t_block) noexcept {
+  return ~t_view.m_bitset.m_bits[t_block];
+}
+
+// 7 bits per byte, the high bit says if there are more bytes
+void RunBitset::RuntimeBitset::writeVarint(std::vector<std::uint8_t>& t_delta, std::size_t t_value) {
+  while (t_value >= 0x80) {
+    t_delta.push_back(static_cast<std::uint8_t>(t_value | 0x80));
+    t_value >>= 7;
+  }
+  t_delta.push_back(static_cast<std::uint8_t>(t_value));
+}
+
+std::size_t RunBitset::RuntimeBitset::readVarint
+(const std::vector<std::uint8_t>& t_delta, std::size_t& t_position) {
+  std::size_t value = 0;
+  for (std::size_t shift = 0; shift < sizeof(std::size_t) * 8; shift += 7) {
+    if (t_position >= t_delta.size()) throw(RunBitsetException::RuntimeBitsetInvalidDelta());
+    const std::uint8_t byte = t_delta[t_position++];
+    value |= static_cast<std::size_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) return value;
+  }
+  throw(RunBitsetException::RuntimeBitsetInvalidDelta()); // too long
+}
+
+template <typename Source1, typename Source2, typename Operation>
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::binaryOperation
+(const Source1& t_1, const Source2& t_2, Operation t_operation) {
+  if (t_1.size() != t_2.size()) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+  RuntimeBitset aux(t_1.size(), uninitialized); // all the blocks are written
+  writeBlocks(aux.m_bits, aux.m_blocks, 
+    [&](std::size_t t_block) {return t_operation(readBlock(t_1, t_block), readBlock(t_2, t_block));},
+    [&](std::size_t t_block) {
+      prefetchBlock(t_1, t_block);
+      prefetchBlock(t_2, t_block);
+    });
+  return aux;
+}
+
+// Same as binaryOperation, but without the temporary bitset
+// t_other can be this (a &= a), each block is only read before being written
+// A shifted view of this (a &= a << 3) reads blocks already written, so it is materialized first
+template <typename Source, typename Operation>
+void RunBitset::RuntimeBitset::applyOperation(const Source& t_other, Operation t_operation) {
+  if (size() != t_other.size()) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+  if constexpr (std::is_same_v<Source, ShiftView>) {
+    if (t_other.m_bitset == this) {
+      applyOperation(static_cast<RuntimeBitset>(t_other), t_operation);
+      return;
+    }
+  }
+  // t_other can share the blocks with this, they are still valid after detaching
+  detach();
+  if (!m_countCached && !m_hasSummary && !m_dirtyTracked) {
+    for (std::size_t i = 0; i < m_blocks; ++i) {
+      m_bits[i] = t_operation(m_bits[i], readBlock(t_other, i));
+    }
+    return;
+  }
+  // Same loop, counting the result and building the first level of the summary at the same time
+  // Only the blocks that really change are marked as dirty
+  std::size_t numberOfActive = 0;
+  if (m_hasSummary) resetSummary();
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    const std::size_t old = m_bits[i];
+    m_bits[i] = t_operation(m_bits[i], readBlock(t_other, i));
+    const std::size_t block = m_bits[i] & getMask(i);
+    if (m_dirtyTracked && block != (old & getMask(i))) markDirty(i);
+    numberOfActive += std::popcount(block);
+    if (m_hasSummary && block != 0) m_summary[0][i / BLOCK_SIZE] |= getMaskPosition(i % BLOCK_SIZE);
+  }
+  if (m_countCached) m_count = numberOfActive;
+  if (m_hasSummary) buildSummaryLevels();
+}
+
+std::size_t RunBitset::RuntimeBitset::extractBlock(const long long t_start) const noexcept {
+  const long long blockSize = static_cast<long long>(BLOCK_SIZE);
+  // floor division, t_start can be negative
+  long long block = t_start / blockSize;
+  long long offset = t_start % blockSize;
+  if (offset < 0) {
+    --block;
+    offset += blockSize;
+  }
+  // Significant bits of the block, 0 if it doesn´t exist
+  auto getSignificant = [this](const long long t_block) -> std::size_t {
+    if (t_block < 0 || t_block >= static_cast<long long>(m_blocks)) return 0;
+    return m_bits[t_block] & getMask(t_block);
+  };
+  const std::size_t low = getSignificant(block);
+  if (offset == 0) return low;
+  const std::size_t high = getSignificant(block + 1);
+  // funnel shift, the upper part of low and the lower part of high
+  return (low >> offset) | (high << (blockSize - offset));
+}
+
+// The view of the bitset has the fill to 0, so its shift is never materialized
+RunBitset::RuntimeBitset::ShiftView 
+RunBitset::RuntimeBitset::operator<<(std::size_t t_pos) const& noexcept {
+  return ShiftView(*this, 0, 0, m_size) << t_pos;
+}
+
+RunBitset::RuntimeBitset::ShiftView 
+RunBitset::RuntimeBitset::operator>>(std::size_t t_pos) const& noexcept {
+  return ShiftView(*this, 0, 0, m_size) >> t_pos;
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::operator<<(std::size_t t_pos) && {
+  *this <<= t_pos;
+  return std::move(*this);
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::operator<<(std::size_t t_pos) const&& {
+  return ShiftView(*this, 0, 0, m_size) << t_pos;
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::operator>>(std::size_t t_pos) && {
+  *this >>= t_pos;
+  return std::move(*this);
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::operator>>(std::size_t t_pos) const&& {
+  return ShiftView(*this, 0, 0, m_size) >> t_pos;
+}
+
+RunBitset::RuntimeBitset& 
+RunBitset::RuntimeBitset::operator<<=(std::size_t t_pos) {
+  detach();
+  this->bitwiseLeft(t_pos);
+  rebuildSummary(); // before recount, it uses the summary
+  recount();
+  markDirty(0, m_blocks);
+  return *this;
 }
 
 RunBitset::RuntimeBitset& 
 RunBitset::RuntimeBitset::operator>>=(std::size_t t_pos) {
+  detach();
   this->bitwiseRight(t_pos);
+  rebuildSummary(); // before recount, it uses the summary
+  recount();
+  markDirty(0, m_blocks);
   return *this;
 }
 
@@ -586,11 +1963,12 @@ void RunBitset::RuntimeBitset::bitwiseLeft(std::size_t t_pos) {
     t_pos -= BLOCK_SIZE;
   }
   if (blockWise > 0) this->shiftBlocksLeft(blockWise);
+  if (t_pos == 0) return; // only blocks, a shift of BLOCK_SIZE bits is undefined
   
   for (long long i = this->m_blocks - 1; i >= 0; --i) {
     // Apply mask
-    const std::size_t remain = (this->m_bits[i] & this->m_mask[i]) >> (BLOCK_SIZE - t_pos);
-    this->m_bits[i] = (this->m_bits[i] & this->m_mask[i]) << t_pos;
+    const std::size_t remain = (this->m_bits[i] & this->getMask(i)) >> (BLOCK_SIZE - t_pos);
+    this->m_bits[i] = (this->m_bits[i] & this->getMask(i)) << t_pos;
     if ((i + 1) < static_cast<long long>(this->m_blocks)) this->m_bits[i + 1] = this->m_bits[i + 1] | remain;
   }
 }
@@ -610,10 +1988,11 @@ void RunBitset::RuntimeBitset::bitwiseRight(std::size_t t_pos) {
     t_pos -= BLOCK_SIZE;
   }
   if (blockWise > 0) this->shiftBlocksRight(blockWise);
+  if (t_pos == 0) return; // only blocks, a shift of BLOCK_SIZE bits is undefined
   for (long long i = 0; i < static_cast<long long>(this->m_blocks); ++i) {
     // Apply mask
-    const std::size_t remain = (this->m_bits[i] & this->m_mask[i]) << (BLOCK_SIZE - t_pos);
-    this->m_bits[i] = (this->m_bits[i] & this->m_mask[i]) >> t_pos;
+    const std::size_t remain = (this->m_bits[i] & this->getMask(i)) << (BLOCK_SIZE - t_pos);
+    this->m_bits[i] = (this->m_bits[i] & this->getMask(i)) >> t_pos;
     if ((i - 1) >= static_cast<long long>(0)) this->m_bits[i - 1] = this->m_bits[i - 1] | remain;
   }
 }
@@ -627,7 +2006,7 @@ void RunBitset::RuntimeBitset::shiftBlocksLeft(std::size_t t_pos) {
     const long long newPos = i + t_pos;
     if (newPos < static_cast<long long>(m_blocks)) {
       // apply mask to avoid bringing crap from the no significant bits
-      m_bits[newPos] = (m_bits[i] & m_mask[i]);
+      m_bits[newPos] = (m_bits[i] & getMask(i));
     }
     m_bits[i] = 0;
   }
@@ -638,16 +2017,403 @@ void RunBitset::RuntimeBitset::shiftBlocksRight(std::size_t t_pos) {
     const long long newPos = i - t_pos;
     if (newPos >= 0) {
       // apply mask to avoid bringing crap from the no significant bits
-      m_bits[newPos] = (m_bits[i] & m_mask[i]);
+      m_bits[newPos] = (m_bits[i] & getMask(i));
     }
     m_bits[i] = 0;
   }
 }
 
 // it is more easy and logical resize the bitset with the size of the string
+std::string RunBitset::RuntimeBitset::to_hex() const {
+  return toDigits(4, HEX_DIGITS);
+}
+
+std::string RunBitset::RuntimeBitset::to_base64() const {
+  return toDigits(6, BASE64_DIGITS);
+}
+
+RunBitset::RuntimeBitset 
+RunBitset::RuntimeBitset::from_hex(const std::string& t_string, const std::size_t t_size) {
+  RuntimeBitset toReturn;
+  toReturn.buildFromDigits(t_string, 4, hexTable(), t_size);
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset 
+RunBitset::RuntimeBitset::from_base64(const std::string& t_string, const std::size_t t_size) {
+  RuntimeBitset toReturn;
+  toReturn.buildFromDigits(t_string, 6, base64Table(), t_size);
+  return toReturn;
+}
+
+// The char i (starting by the end) is the value of the bits [i * t_bits, (i + 1) * t_bits)
+std::string RunBitset::RuntimeBitset::toDigits(const std::size_t t_bits, const char* t_alphabet) const {
+  const std::size_t digits = (m_size + t_bits - 1) / t_bits;
+  std::string toReturn(digits, '0');
+  auto block = [this](const std::size_t t_block) {return m_bits[t_block] & getMask(t_block);};
+  writeDigitRange(block, m_blocks, 0, digits, t_bits, t_alphabet, toReturn.data());
+  return toReturn;
+}
+
+// The digits are always inside the bitset, so no bounds like extractBlock
+template <typename BlockFunction>
+std::size_t RunBitset::RuntimeBitset::getDigit(const BlockFunction& t_block, const std::size_t t_blocks,
+  const std::size_t t_digit, const std::size_t t_bits) noexcept {
+  const std::size_t position = t_digit * t_bits;
+  const std::size_t block = position / BLOCK_SIZE;
+  const std::size_t offset = position % BLOCK_SIZE;
+  std::size_t value = t_block(block) >> offset;
+  // The rest of the digit is in the next block
+  if (offset + t_bits > BLOCK_SIZE && block + 1 < t_blocks) {
+    value |= t_block(block + 1) << (BLOCK_SIZE - offset);
+  }
+  return value & ((static_cast<std::size_t>(1) << t_bits) - 1);
+}
+
+// With SSSE3 the hex digits of the whole blocks are written 16 at a time, the rest one by one
+template <typename BlockFunction>
+void RunBitset::RuntimeBitset::writeDigitRange(const BlockFunction& t_block, const std::size_t t_blocks, 
+  const std::size_t t_first, const std::size_t t_last, const std::size_t t_bits, 
+  const char* t_alphabet, char* t_destination) noexcept {
+  std::size_t i = t_last;
+#if defined(RUNBITSET_SSSE3_HEX)
+  if (t_bits == 4) {
+    constexpr std::size_t DIGITS_PER_BLOCK = BLOCK_SIZE / 4;
+    // One by one until the start of a block
+    for (; i > t_first && i % DIGITS_PER_BLOCK != 0; --i) {
+      *t_destination++ = t_alphabet[getDigit(t_block, t_blocks, i - 1, t_bits)];
+    }
+    for (; i >= t_first + DIGITS_PER_BLOCK; i -= DIGITS_PER_BLOCK) {
+      encodeHexBlock(t_block(i / DIGITS_PER_BLOCK - 1), t_alphabet, t_destination);
+      t_destination += DIGITS_PER_BLOCK;
+    }
+  }
+#endif
+  for (; i > t_first; --i) {
+    *t_destination++ = t_alphabet[getDigit(t_block, t_blocks, i - 1, t_bits)];
+  }
+}
+
+#if defined(RUNBITSET_SSSE3_HEX)
+void RunBitset::RuntimeBitset::encodeHexBlock
+(const std::size_t t_block, const char* t_alphabet, char* t_destination) noexcept {
+  const __m128i lowNibble = _mm_set1_epi8(0x0f);
+  const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  const __m128i alphabet = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_alphabet));
+  const __m128i bytes = _mm_cvtsi64_si128(static_cast<long long>(t_block));
+  const __m128i low = _mm_and_si128(bytes, lowNibble);
+  const __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), lowNibble);
+  // low0, high0, low1... are the digits starting by the less significant, reversed the most significant is first
+  const __m128i digits = _mm_shuffle_epi8(_mm_unpacklo_epi8(low, high), reverse);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(t_destination), _mm_shuffle_epi8(alphabet, digits));
+}
+
+// Same chars as hexTable(): 0-9, a-f and A-F
+bool RunBitset::RuntimeBitset::decodeHexBlock(const char* t_chars, std::size_t& t_block) noexcept {
+  const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_chars));
+  // Signed compares, the chars >= 128 are negative and never valid
+  const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), 
+    _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+  const __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+  const __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), 
+    _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+  if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xffff) return false;
+  const __m128i values = _mm_or_si128(_mm_and_si128(isDigit, _mm_sub_epi8(chars, _mm_set1_epi8('0'))), 
+    _mm_and_si128(isLetter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+  // The less significant digit first, then each pair of digits is a byte (first + second * 16)
+  const __m128i pairs = _mm_maddubs_epi16(_mm_shuffle_epi8(values, reverse), _mm_set1_epi16(0x1001));
+  t_block = static_cast<std::size_t>(_mm_cvtsi128_si64(_mm_packus_epi16(pairs, pairs)));
+  return true;
+}
+#endif
+
+// The mask of the last block is applied here, readBlock doesn´t do it for all the sources
+template <typename Source>
+void RunBitset::RuntimeBitset::writeText(std::ostream& t_stream, const Source& t_source) {
+  const std::size_t size = t_source.size();
+  const std::size_t blocks = getNumberBlocks(size);
+  const std::size_t lastMask = getLastMask(size - (blocks - 1) * BLOCK_SIZE);
+  auto block = [&](const std::size_t t_block) {
+    return readBlock(t_source, t_block) & ((t_block == blocks - 1) ? lastMask : ALL_BITS_ONE);
+  };
+  switch (textFormat(t_stream)) {
+    case HEX_FORMAT: writeDigits(t_stream, block, size, 4, HEX_DIGITS); break;
+    case BASE64_FORMAT: writeDigits(t_stream, block, size, 6, BASE64_DIGITS); break;
+    default: writeDigits(t_stream, block, size, 1, "01");
+  }
+}
+
+// Like operator<< of std::string, the width and the fill of the stream are applied
+template <typename BlockFunction>
+void RunBitset::RuntimeBitset::writeDigits(std::ostream& t_stream, const BlockFunction& t_block, 
+  const std::size_t t_size, const std::size_t t_bits, const char* t_alphabet) {
+  const std::ostream::sentry sentry(t_stream);
+  if (!sentry) return;
+  const std::size_t blocks = getNumberBlocks(t_size);
+  const std::size_t digits = (t_size + t_bits - 1) / t_bits;
+  const std::size_t width = static_cast<std::size_t>(std::max<std::streamsize>(t_stream.width(), 0));
+  const std::size_t padding = (width > digits) ? width - digits : 0;
+  const bool left = (t_stream.flags() & std::ios_base::adjustfield) == std::ios_base::left;
+  auto pad = [&]() {
+    for (std::size_t i = 0; i < padding; ++i) t_stream.rdbuf()->sputc(t_stream.fill());
+  };
+  if (!left) pad();
+  char buffer[STREAM_CHUNK];
+  // The most significant first, the chunks start in multiples of STREAM_CHUNK (and of whole blocks with hex)
+  for (std::size_t last = digits; last > 0;) {
+    const std::size_t first = (last - 1) / STREAM_CHUNK * STREAM_CHUNK;
+    const std::streamsize used = static_cast<std::streamsize>(last - first);
+    writeDigitRange(t_block, blocks, first, last, t_bits, t_alphabet, buffer);
+    if (t_stream.rdbuf()->sputn(buffer, used) != used) {
+      t_stream.setstate(std::ios_base::badbit);
+      return;
+    }
+    last = first;
+  }
+  if (left) pad();
+  t_stream.width(0);
+}
+
+// The size is not known until the end, and the first digit is the most significant
+// So the digits are stored in the reading order (the first digit in the position 0) with their bits reversed,
+//   in blocks grown with realloc that become the blocks of the bitset. At the end, reversing all the bits
+//   leaves each digit in its real position with its bits in order, only displaced by the unused bits
+// No second copy of the bitset: the peak of memory is the blocks (and the unused part of the last realloc)
+// Like operator>> of std::string, at most width() digits if it is not 0, and the width is 0 after it
+void RunBitset::RuntimeBitset::readDigits
+(std::istream& t_stream, const std::size_t t_bits, const std::array<signed char, 256>& t_table) {
+  struct ResetWidth {
+    std::istream& stream;
+    ~ResetWidth() {stream.width(0);}
+  };
+  const ResetWidth resetWidth{t_stream}; // also if it fails or throws
+  const std::size_t maxDigits = (t_stream.width() > 0) 
+    ? static_cast<std::size_t>(t_stream.width()) : std::numeric_limits<std::size_t>::max();
+  const std::istream::sentry sentry(t_stream); // skips the whitespaces
+  if (!sentry) return;
+  std::streambuf* buffer = t_stream.rdbuf();
+  const std::ctype<char>& ctype = std::use_facet<std::ctype<char>>(t_stream.getloc());
+  struct FreeBlocks {
+    void operator()(std::size_t* t_blocks) const noexcept {std::free(t_blocks);}
+  };
+  std::unique_ptr<std::size_t, FreeBlocks> read;
+  std::size_t capacity = 0; // in blocks, the blocks are not initialized (nor touched) until a digit is written
+  std::array<std::size_t, 64> reversedDigit{}; // t_bits <= 6
+  for (std::size_t value = 0; value < (static_cast<std::size_t>(1) << t_bits); ++value) {
+    reversedDigit[value] = reverseBits(value) >> (BLOCK_SIZE - t_bits);
+  }
+  std::size_t digits = 0;
+  while (digits < maxDigits) {
+    const std::streambuf::int_type c = buffer->sgetc();
+    if (std::streambuf::traits_type::eq_int_type(c, std::streambuf::traits_type::eof())) {
+      t_stream.setstate(std::ios_base::eofbit);
+      break;
+    }
+    const char character = std::streambuf::traits_type::to_char_type(c);
+    if (ctype.is(std::ctype_base::space, character)) break;
+    const signed char value = t_table[static_cast<unsigned char>(character)];
+    if (value < 0) throw(RunBitsetException::RuntimeBitsetUnknownChar());
+    buffer->sbumpc();
+    const std::size_t position = digits * t_bits;
+    if (position + t_bits > capacity * BLOCK_SIZE) {
+      const std::size_t newCapacity = std::max(capacity * 2, STREAM_CHUNK / sizeof(std::size_t));
+      void* memory = std::realloc(read.get(), newCapacity * sizeof(std::size_t));
+      if (memory == nullptr) throw(std::bad_alloc());
+      static_cast<void>(read.release()); // already freed by realloc
+      read.reset(static_cast<std::size_t*>(memory));
+      capacity = newCapacity;
+    }
+    const std::size_t reversed = reversedDigit[static_cast<std::size_t>(value)];
+    const std::size_t block = position / BLOCK_SIZE;
+    const std::size_t offset = position % BLOCK_SIZE;
+    // The first digit of a block initializes it, the blocks are written in order
+    if (offset == 0) read.get()[block] = reversed;
+    else read.get()[block] |= reversed << offset;
+    // The rest of the digit starts the next block
+    if (offset + t_bits > BLOCK_SIZE) read.get()[block + 1] = reversed >> (BLOCK_SIZE - offset);
+    ++digits;
+  }
+  if (digits == 0) { // like std::bitset, nothing read is a failure
+    t_stream.setstate(std::ios_base::failbit);
+    return;
+  }
+  const std::size_t size = digits * t_bits;
+  const std::size_t blocks = getNumberBlocks(size);
+  if (blocks < capacity) { // give back the unused part, usually in place
+    void* memory = std::realloc(read.get(), blocks * sizeof(std::size_t));
+    if (memory != nullptr) {
+      static_cast<void>(read.release());
+      read.reset(static_cast<std::size_t*>(memory));
+    }
+  }
+  adoptBlocks(read.get(), size);
+  static_cast<void>(read.release());
+  // All the bits reversed, then the first bit is in the position unused
+  std::reverse(m_bits, m_bits + m_blocks);
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    m_bits[i] = reverseBits(m_bits[i]);
+  }
+  const std::size_t unused = m_blocks * BLOCK_SIZE - m_size;
+  if (unused != 0) {
+    for (std::size_t i = 0; i < m_blocks; ++i) {
+      const std::size_t high = (i + 1 < m_blocks) ? m_bits[i + 1] << (BLOCK_SIZE - unused) : 0;
+      m_bits[i] = (m_bits[i] >> unused) | high;
+    }
+  }
+  rebuildSummary(); // before recount, it uses the summary
+  recount();
+  markAllDirty();
+}
+
+// Swaps the halves, then the quarters of each half... until the single bits
+constexpr std::size_t RunBitset::RuntimeBitset::reverseBits(std::size_t t_block) noexcept {
+  for (std::size_t shift = BLOCK_SIZE / 2; shift > 0; shift /= 2) {
+    // shift bits at 1 and shift bits at 0, repeated
+    const std::size_t low = ALL_BITS_ONE / ((static_cast<std::size_t>(1) << shift) + 1);
+    t_block = ((t_block >> shift) & low) | ((t_block & low) << shift);
+  }
+  return t_block;
+}
+
+void RunBitset::RuntimeBitset::buildFromDigits(const std::string& t_string, const std::size_t t_bits, 
+  const std::array<signed char, 256>& t_table, const std::size_t t_size) {
+  const std::size_t size = (t_size != 0) ? t_size : t_string.size() * t_bits;
+  build(size); // all 0, the digits are added with |
+  const std::size_t digits = t_string.size();
+  std::size_t i = 0;
+#if defined(RUNBITSET_SSSE3_HEX)
+  // Whole blocks, until one has a char that is not hex (the loop below throws)
+  constexpr std::size_t DIGITS_PER_BLOCK = BLOCK_SIZE / 4;
+  if (t_bits == 4) {
+    for (; i + DIGITS_PER_BLOCK <= digits && i / DIGITS_PER_BLOCK < m_blocks; i += DIGITS_PER_BLOCK) {
+      if (!decodeHexBlock(t_string.data() + digits - DIGITS_PER_BLOCK - i, m_bits[i / DIGITS_PER_BLOCK])) break;
+    }
+  }
+#endif
+  for (; i < digits; ++i) {
+    const signed char value = t_table[static_cast<unsigned char>(t_string[digits - 1 - i])];
+    if (value < 0) throw(RunBitsetException::RuntimeBitsetUnknownChar());
+    const std::size_t position = i * t_bits;
+    if (position >= m_size) continue; // out of the size, ignored
+    const std::size_t block = position / BLOCK_SIZE;
+    const std::size_t offset = position % BLOCK_SIZE;
+    m_bits[block] |= static_cast<std::size_t>(value) << offset;
+    // The rest of the digit goes to the next block
+    if (offset + t_bits > BLOCK_SIZE && block + 1 < m_blocks) {
+      m_bits[block + 1] |= static_cast<std::size_t>(value) >> (BLOCK_SIZE - offset);
+    }
+  }
+  m_bits[m_blocks - 1] &= m_lastMask;
+  rebuildSummary(); // before recount, it uses the summary
+  recount();
+  markAllDirty();
+}
+
+constexpr std::array<signed char, 256> 
+RunBitset::RuntimeBitset::buildDigitTable(const char* t_alphabet, const std::size_t t_digits) {
+  std::array<signed char, 256> table{};
+  for (signed char& value : table) {
+    value = -1;
+  }
+  for (std::size_t i = 0; i < t_digits; ++i) {
+    table[static_cast<unsigned char>(t_alphabet[i])] = static_cast<signed char>(i);
+  }
+  return table;
+}
+
+// Built at compile time
+const std::array<signed char, 256>& RunBitset::RuntimeBitset::binaryTable() noexcept {
+  static constexpr std::array<signed char, 256> table = buildDigitTable("01", 2);
+  return table;
+}
+
+const std::array<signed char, 256>& RunBitset::RuntimeBitset::hexTable() noexcept {
+  static constexpr std::array<signed char, 256> table = [] {
+    std::array<signed char, 256> lower = buildDigitTable(HEX_DIGITS, 16);
+    for (signed char i = 10; i < 16; ++i) lower['A' + i - 10] = i; // upper case too
+    return lower;
+  }();
+  return table;
+}
+
+const std::array<signed char, 256>& RunBitset::RuntimeBitset::base64Table() noexcept {
+  static constexpr std::array<signed char, 256> table = buildDigitTable(BASE64_DIGITS, 64);
+  return table;
+}
+
+long& RunBitset::RuntimeBitset::textFormat(std::ios_base& t_stream) {
+  static const int index = std::ios_base::xalloc(); // 0 (binary) in all the streams by default
+  return t_stream.iword(index);
+}
+
+template <typename Iterator>
+constexpr bool RunBitset::RuntimeBitset::parseFormat
+(Iterator& t_position, const Iterator t_end, FormatSpec& t_spec) noexcept {
+  // At least one digit, and not 0
+  auto readNumber = [&](std::size_t& t_number) {
+    t_number = 0;
+    bool digits = false;
+    for (; t_position != t_end && *t_position >= '0' && *t_position <= '9'; ++t_position) {
+      t_number = t_number * 10 + static_cast<std::size_t>(*t_position - '0');
+      digits = true;
+    }
+    return digits && t_number != 0;
+  };
+  if (t_position != t_end && (*t_position == 'h' || *t_position == 't')) {
+    const bool leading = (*t_position == 'h');
+    ++t_position;
+    if (!readNumber(leading ? t_spec.leading : t_spec.trailing)) return false;
+  }
+  if (t_position != t_end) {
+    const char separator = *t_position;
+    if (separator == '_' || separator == '\'' || separator == ',' || separator == '.' || 
+      separator == ':' || separator == ' ') {
+      ++t_position;
+      t_spec.separator = separator;
+      if (!readNumber(t_spec.group)) return false;
+    }
+  }
+  if (t_position != t_end && (*t_position == 'b' || *t_position == 'x' || *t_position == 'X')) {
+    t_spec.type = *t_position;
+    ++t_position;
+  }
+  return true;
+}
+
+template <typename OutputIterator>
+OutputIterator RunBitset::RuntimeBitset::formatTo(OutputIterator t_out, const FormatSpec& t_spec) const {
+  // Bits [first, last) of the bitset
+  std::size_t first = 0;
+  std::size_t last = m_size;
+  if (t_spec.leading != 0 && t_spec.leading < m_size) first = m_size - t_spec.leading;
+  if (t_spec.trailing != 0 && t_spec.trailing < m_size) last = t_spec.trailing;
+  const std::size_t bits = (t_spec.type == 'b') ? 1 : 4;
+  const char* alphabet = (t_spec.type == 'b') ? "01" : (t_spec.type == 'X') ? "0123456789ABCDEF" : HEX_DIGITS;
+  const std::size_t digits = (last - first + bits - 1) / bits;
+  const std::size_t digitMask = (static_cast<std::size_t>(1) << bits) - 1;
+  const std::size_t blockDigits = BLOCK_SIZE / bits;
+  char buffer[BLOCK_SIZE * 2]; // one block of digits, and a separator after each one at most
+  // One block is extracted for each batch of digits, the most significant batch can be shorter
+  for (std::size_t remaining = digits; remaining > 0;) {
+    const std::size_t batch = (remaining % blockDigits != 0) ? remaining % blockDigits : blockDigits;
+    remaining -= batch; // digits under this batch
+    const std::size_t position = first + remaining * bits;
+    std::size_t value = extractBlock(static_cast<long long>(position));
+    // The last digit can have less bits
+    if (last - position < BLOCK_SIZE) value &= (static_cast<std::size_t>(1) << (last - position)) - 1;
+    std::size_t used = 0;
+    for (std::size_t i = remaining + batch; i > remaining; --i) { // the most significant first
+      buffer[used++] = alphabet[(value >> ((i - 1 - remaining) * bits)) & digitMask];
+      if (t_spec.group != 0 && i != 1 && (i - 1) % t_spec.group == 0) buffer[used++] = t_spec.separator;
+    }
+    t_out = std::copy(buffer, buffer + used, t_out);
+  }
+  return t_out;
+}
+
 void RunBitset::RuntimeBitset::buildFromString(const std::string& t_string) {
-  destroy();
-  build(t_string.size());
+  build(t_string.size()); // all 0, only the 1 are written
   const std::size_t sizeAux = t_string.size() - 1;
   for (std::size_t i = 0; i < t_string.size(); ++i) {
     if (t_string[i] == '1') {
@@ -660,6 +2426,8 @@ void RunBitset::RuntimeBitset::buildFromString(const std::string& t_string) {
       throw(RunBitsetException::RuntimeBitsetUnknownChar());
     }
   }
+  rebuildSummary(); // before recount, it uses the summary
+  recount();
 }
 
 RunBitset::RuntimeBitset::Reference 
@@ -691,4 +2459,280 @@ bool RunBitset::RuntimeBitset::Reference::operator~() const {
 RunBitset::RuntimeBitset::Reference& RunBitset::RuntimeBitset::Reference::flip() {
   m_bitset.flip(m_position);
   return *this;
-}
\ No newline at end of file
+}
+
+// COMPLEMENT VIEW
+bool RunBitset::RuntimeBitset::ComplementView::operator[](std::size_t t_position) const {
+  return !m_bitset.getValueInPosition(t_position);
+}
+
+bool RunBitset::RuntimeBitset::ComplementView::test(std::size_t t_position) const {
+  return !m_bitset.getValueInPosition(t_position);
+}
+
+// All the complement is 1 only if the bitset is all 0, and so on
+bool RunBitset::RuntimeBitset::ComplementView::all() const noexcept {
+  return m_bitset.none();
+}
+
+bool RunBitset::RuntimeBitset::ComplementView::any() const noexcept {
+  return !m_bitset.all();
+}
+
+bool RunBitset::RuntimeBitset::ComplementView::none() const noexcept {
+  return m_bitset.all();
+}
+
+std::size_t RunBitset::RuntimeBitset::ComplementView::count() const noexcept {
+  return m_bitset.size() - m_bitset.count();
+}
+
+// The summary only knows the blocks with active bits, so it doesn´t help to find the 0 of the bitset
+std::size_t RunBitset::RuntimeBitset::ComplementView::find_first() const noexcept {
+  return find_next(0);
+}
+
+std::size_t RunBitset::RuntimeBitset::ComplementView::find_next(const std::size_t t_position) const noexcept {
+  if (t_position >= size()) return size();
+  std::size_t block = t_position / BLOCK_SIZE;
+  const std::size_t first = ~m_bitset.m_bits[block] & m_bitset.getMask(block) & (ALL_BITS_ONE << (t_position % BLOCK_SIZE));
+  if (first != 0) return block * BLOCK_SIZE + std::countr_zero(first);
+  for (++block; block < m_bitset.m_blocks; ++block) {
+    const std::size_t current = ~m_bitset.m_bits[block] & m_bitset.getMask(block);
+    if (current != 0) return block * BLOCK_SIZE + std::countr_zero(current);
+  }
+  return size();
+}
+
+std::string RunBitset::RuntimeBitset::ComplementView::to_string() const noexcept {
+  std::string toReturn = m_bitset.to_string();
+  for (char& c : toReturn) {
+    c = (c == '1') ? '0' : '1';
+  }
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset::ComplementView::operator RuntimeBitset() const {
+  RuntimeBitset toReturn(m_bitset.size(), uninitialized);
+  for (std::size_t i = 0; i < toReturn.m_blocks; ++i) {
+    toReturn.m_bits[i] = ~m_bitset.m_bits[i];
+  }
+  return toReturn;
+}
+
+// set() and flip() don´t need the complement
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ComplementView::set() const {
+  RuntimeBitset toReturn(size(), uninitialized);
+  toReturn.set();
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ComplementView::set(const std::size_t t_position) const {
+  RuntimeBitset toReturn = *this;
+  toReturn.set(t_position);
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ComplementView::reset() const {
+  return RuntimeBitset(size());
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ComplementView::reset(const std::size_t t_position) const {
+  RuntimeBitset toReturn = *this;
+  toReturn.reset(t_position);
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ComplementView::flip() const {
+  RuntimeBitset toReturn(m_bitset);
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ComplementView::flip(const std::size_t t_position) const {
+  RuntimeBitset toReturn = *this;
+  toReturn.flip(t_position);
+  return toReturn;
+}
+
+// The shifted in bits are 0, only the bits of the bitset are complemented
+RunBitset::RuntimeBitset::ShiftView 
+RunBitset::RuntimeBitset::ComplementView::operator<<(std::size_t t_pos) const {
+  return ShiftView(m_bitset, 0, 0, size(), true) << t_pos;
+}
+
+RunBitset::RuntimeBitset::ShiftView 
+RunBitset::RuntimeBitset::ComplementView::operator>>(std::size_t t_pos) const {
+  return ShiftView(m_bitset, 0, 0, size(), true) >> t_pos;
+}
+
+// SHIFT VIEW
+RunBitset::RuntimeBitset::ShiftView::ShiftView(std::shared_ptr<const RuntimeBitset> t_owned)
+: m_bitset(t_owned.get()), m_owned(std::move(t_owned)), m_offset(0), m_first(0), m_last(m_bitset->size()), 
+  m_complement(false), m_fill(false) {}
+
+bool RunBitset::RuntimeBitset::ShiftView::operator[](std::size_t t_position) const {
+  return test(t_position);
+}
+
+bool RunBitset::RuntimeBitset::ShiftView::test(std::size_t t_position) const {
+  if (t_position >= size()) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  if (t_position < m_first || t_position >= m_last) return m_fill;
+  return m_complement != m_bitset->getValueInPosition(static_cast<std::size_t>(static_cast<long long>(t_position) - m_offset));
+}
+
+bool RunBitset::RuntimeBitset::ShiftView::all() const noexcept {
+  for (std::size_t i = 0; i < m_bitset->m_blocks; ++i) {
+    if (getBlock(i) != m_bitset->getMask(i)) return false;
+  }
+  return true;
+}
+
+bool RunBitset::RuntimeBitset::ShiftView::any() const noexcept {
+  for (std::size_t i = 0; i < m_bitset->m_blocks; ++i) {
+    if (getBlock(i) != 0) return true;
+  }
+  return false;
+}
+
+bool RunBitset::RuntimeBitset::ShiftView::none() const noexcept {
+  return !any();
+}
+
+std::size_t RunBitset::RuntimeBitset::ShiftView::count() const noexcept {
+  std::size_t numberOfActive = 0;
+  // Without fill, only the blocks inside [first, last) can have active bits
+  const std::size_t firstBlock = m_fill ? 0 : m_first / BLOCK_SIZE;
+  const std::size_t lastBlock = m_fill ? m_bitset->m_blocks : (m_last + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  for (std::size_t i = firstBlock; i < lastBlock; ++i) {
+    numberOfActive += std::popcount(getBlock(i));
+  }
+  return numberOfActive;
+}
+
+std::size_t RunBitset::RuntimeBitset::ShiftView::find_first() const noexcept {
+  return find_next(0);
+}
+
+std::size_t RunBitset::RuntimeBitset::ShiftView::find_next(const std::size_t t_position) const noexcept {
+  if (t_position >= size()) return size();
+  std::size_t block = t_position / BLOCK_SIZE;
+  const std::size_t first = getBlock(block) & (ALL_BITS_ONE << (t_position % BLOCK_SIZE));
+  if (first != 0) return block * BLOCK_SIZE + std::countr_zero(first);
+  // Without fill, there is nothing after the block of last
+  const std::size_t lastBlock = m_fill ? m_bitset->m_blocks : (m_last + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  for (++block; block < lastBlock; ++block) {
+    const std::size_t current = getBlock(block);
+    if (current != 0) return block * BLOCK_SIZE + std::countr_zero(current);
+  }
+  return size();
+}
+
+std::string RunBitset::RuntimeBitset::ShiftView::to_string() const noexcept {
+  return static_cast<RuntimeBitset>(*this).to_string();
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ShiftView::set() const {
+  RuntimeBitset toReturn(size(), uninitialized);
+  toReturn.set();
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ShiftView::set(const std::size_t t_position) const {
+  RuntimeBitset toReturn = *this;
+  toReturn.set(t_position);
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ShiftView::reset() const {
+  return RuntimeBitset(size());
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ShiftView::reset(const std::size_t t_position) const {
+  RuntimeBitset toReturn = *this;
+  toReturn.reset(t_position);
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ShiftView::flip() const {
+  return ~*this;
+}
+
+RunBitset::RuntimeBitset RunBitset::RuntimeBitset::ShiftView::flip(const std::size_t t_position) const {
+  RuntimeBitset toReturn = *this;
+  toReturn.flip(t_position);
+  return toReturn;
+}
+
+// Left shift: position i comes from i - t_pos, the valid range moves up and is cut by the size
+// The shifted in bits are 0, with fill 1 the view can´t represent it (0, then 1, then the range...)
+RunBitset::RuntimeBitset::ShiftView 
+RunBitset::RuntimeBitset::ShiftView::operator<<(std::size_t t_pos) const {
+  if (m_fill) return ShiftView(std::make_shared<const RuntimeBitset>(*this)) << t_pos;
+  ShiftView toReturn(*this);
+  toReturn.m_offset += static_cast<long long>(std::min(t_pos, size()));
+  toReturn.m_first = (t_pos >= size()) ? 0 : std::min(m_first + t_pos, size());
+  toReturn.m_last = (t_pos >= size()) ? 0 : std::min(m_last + t_pos, size()); // everything shifted out
+  return toReturn;
+}
+
+// Right shift: position i comes from i + t_pos, the valid range moves down and is cut by 0
+RunBitset::RuntimeBitset::ShiftView 
+RunBitset::RuntimeBitset::ShiftView::operator>>(std::size_t t_pos) const {
+  if (m_fill) return ShiftView(std::make_shared<const RuntimeBitset>(*this)) >> t_pos;
+  ShiftView toReturn(*this);
+  toReturn.m_offset -= static_cast<long long>(std::min(t_pos, size()));
+  toReturn.m_first = (m_first > t_pos) ? m_first - t_pos : 0;
+  toReturn.m_last = (m_last > t_pos) ? m_last - t_pos : 0;
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset::ShiftView RunBitset::RuntimeBitset::ShiftView::operator~() const noexcept {
+  ShiftView toReturn(*this);
+  toReturn.m_complement = !m_complement;
+  toReturn.m_fill = !m_fill;
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset::ShiftView::operator RuntimeBitset() const {
+  RuntimeBitset toReturn(size(), uninitialized);
+  for (std::size_t i = 0; i < toReturn.m_blocks; ++i) {
+    toReturn.m_bits[i] = getBlock(i);
+  }
+  return toReturn;
+}
+
+std::size_t RunBitset::RuntimeBitset::ShiftView::getBlock(const std::size_t t_block) const noexcept {
+  const std::size_t blockStart = t_block * BLOCK_SIZE;
+  const std::size_t fill = m_fill ? ALL_BITS_ONE : 0;
+  // Part of [first, last) inside the block
+  const std::size_t low = std::clamp(m_first, blockStart, blockStart + BLOCK_SIZE) - blockStart;
+  const std::size_t high = std::clamp(m_last, blockStart, blockStart + BLOCK_SIZE) - blockStart;
+  if (low >= high) return fill & m_bitset->getMask(t_block);
+  const std::size_t rangeMask = (ALL_BITS_ONE >> (BLOCK_SIZE - (high - low))) << low;
+  const long long start = static_cast<long long>(blockStart) - m_offset;
+  std::size_t value = m_bitset->extractBlock(start);
+  if (m_complement) value = ~value;
+  return ((value & rangeMask) | (fill & ~rangeMask)) & m_bitset->getMask(t_block);
+}
+
+#if defined(__cpp_lib_format)
+// std::format("{:x}", bitset), see RuntimeBitset::FormatSpec
+template <>
+struct std::formatter<RunBitset::RuntimeBitset, char> {
+  constexpr auto parse(std::format_parse_context& t_context) {
+    auto position = t_context.begin();
+    if (!RunBitset::RuntimeBitset::parseFormat(position, t_context.end(), m_spec) || 
+      (position != t_context.end() && *position != '}')) {
+      throw std::format_error("Invalid format for RuntimeBitset");
+    }
+    return position;
+  }
+
+  template <typename FormatContext>
+  auto format(const RunBitset::RuntimeBitset& t_bitset, FormatContext& t_context) const {
+    return t_bitset.formatTo(t_context.out(), m_spec);
+  }
+
+  RunBitset::RuntimeBitset::FormatSpec m_spec;
+};
+#endif
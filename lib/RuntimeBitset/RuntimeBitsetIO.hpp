@@ -0,0 +1,390 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, binary files of RuntimeBitset, with synchronous and asynchronous load and save
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <bit>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <thread>
+#include <exception>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#define RUNBITSET_POSITIONAL_IO
+#endif
+
+namespace RunBitsetException {
+
+class RuntimeBitsetFileError : public RuntimeBitsetException {
+  public:
+    RuntimeBitsetFileError() : RuntimeBitsetException("Error opening, reading or writing the file") {}
+};
+
+class RuntimeBitsetInvalidFile : public RuntimeBitsetException {
+  public:
+    RuntimeBitsetInvalidFile() : RuntimeBitsetException("The file is not a bitset file or it is corrupted") {}
+};
+
+class RuntimeBitsetLoadCancelled : public RuntimeBitsetException {
+  public:
+    RuntimeBitsetLoadCancelled() : RuntimeBitsetException("The loading was stopped before the end") {}
+};
+
+}
+
+namespace RunBitset {
+
+// File read and written by offset (pread and pwrite where they exist),
+//   so several reads can be in flight at the same time
+class PositionalFile {
+  public:
+    // READ only reads, CREATE makes an empty file (or empties it), UPDATE reads and writes an existing one
+    enum Mode {READ, CREATE, UPDATE};
+    inline PositionalFile(const std::string& t_path, const Mode t_mode);
+    inline ~PositionalFile();
+    PositionalFile(const PositionalFile&) = delete;
+    PositionalFile& operator=(const PositionalFile&) = delete;
+
+    // All the bytes or RuntimeBitsetFileError
+    inline void readAt(const std::uint64_t t_offset, void* t_buffer, const std::size_t t_bytes);
+    inline void writeAt(const std::uint64_t t_offset, const void* t_buffer, const std::size_t t_bytes);
+    inline std::uint64_t fileSize();
+
+  private:
+#if defined(RUNBITSET_POSITIONAL_IO)
+    int m_file = -1;
+#else
+    std::FILE* m_file = nullptr;
+    std::mutex m_mutex; // seek and read are not atomic
+#endif
+};
+
+// Binary format, words of 64 bits in little endian:
+//   MAGIC, size in bits, number of blocks, the blocks (the no significant bits are 0), checksum of the blocks
+// The blocks are read and written by chunks of CHUNK_BLOCKS, the next chunk is read (or the last one
+//   is written) while the current one is checked (or prepared)
+class BitsetFile {
+  public:
+    inline static constexpr std::uint64_t MAGIC = 0x31535449424e5552; // "RUNBITS1"
+    inline static constexpr std::size_t HEADER_WORDS = 3;
+    inline static constexpr std::size_t CHUNK_BLOCKS = 1024 * 1024; // 8 MB
+
+    inline static void save(const RuntimeBitset& t_bitset, const std::string& t_path);
+    inline static RuntimeBitset load(const std::string& t_path);
+    // In another thread, the bitset must not be modified or destroyed until the future is ready
+    inline static std::future<void> saveAsync(const RuntimeBitset& t_bitset, const std::string& t_path);
+
+    // Loads the file in another thread, the bits already loaded can be read meanwhile
+    // The checksum is only checked at the end, completion() has the error if it doesn´t match
+    class Loader {
+      public:
+        // The header is read here, so size() is known at once
+        inline explicit Loader(const std::string& t_path);
+        inline ~Loader(); // stops the loading if it is not finished
+        Loader(const Loader&) = delete;
+        Loader& operator=(const Loader&) = delete;
+
+        inline std::size_t size() const noexcept {return m_bitset.size();}
+        // Bits [0, loadedBits()) can be read
+        inline std::size_t loadedBits() const noexcept;
+        // Waits until t_position is loaded
+        inline bool test(const std::size_t t_position) const;
+        // It can outlive the Loader, if the Loader is destroyed before the end it has RuntimeBitsetLoadCancelled
+        inline std::shared_future<void> completion() const {return m_completion;}
+        // Wait until the end (throws the error of the loading if any)
+        inline RuntimeBitset& get();
+        inline RuntimeBitset release();
+
+      private:
+        inline void run();
+        inline void waitFor(const std::size_t t_blocks) const;
+
+        PositionalFile m_file;
+        RuntimeBitset m_bitset;
+        std::atomic<std::size_t> m_loaded{0}; // blocks
+        std::atomic<bool> m_stop{false};
+        mutable std::mutex m_mutex;
+        mutable std::condition_variable m_condition;
+        std::exception_ptr m_error;
+        std::promise<void> m_promise;
+        std::shared_future<void> m_completion;
+        std::thread m_thread;
+    };
+
+  private:
+    static_assert(RuntimeBitset::blockSize() == 64, "the file format uses blocks of 64 bits");
+    inline static constexpr std::uint64_t HASH_OFFSET = 0xcbf29ce484222325;
+    inline static constexpr std::uint64_t HASH_PRIME = 0x100000001b3;
+
+    // FNV-1a by words
+    inline static std::uint64_t checksum(std::uint64_t t_hash, const std::size_t* t_blocks, const std::size_t t_count) noexcept;
+    inline static std::uint64_t toLittleEndian(const std::uint64_t t_word) noexcept;
+    inline static std::size_t* getBlocks(RuntimeBitset& t_bitset) noexcept {return t_bitset.m_bits;}
+    inline static const std::size_t* getBlocks(const RuntimeBitset& t_bitset) noexcept {return t_bitset.m_bits;}
+    inline static std::size_t getMask(const RuntimeBitset& t_bitset, const std::size_t t_block) noexcept;
+    // The bitset was written directly, update its count, summary...
+    inline static void refresh(RuntimeBitset& t_bitset);
+    inline static std::uint64_t blocksOffset(const std::size_t t_block) noexcept;
+    // Check the header and the length of the file, returns the size of the bitset
+    inline static std::size_t readHeader(PositionalFile& t_file);
+
+    // The other file based containers use the same format
+    friend class DiskBitset;
+    friend class BitsetCombiner;
+};
+
+} // namespace RunBitset
+
+
+RunBitset::PositionalFile::PositionalFile(const std::string& t_path, const Mode t_mode) {
+#if defined(RUNBITSET_POSITIONAL_IO)
+  const int flags = (t_mode == READ) ? O_RDONLY : (t_mode == CREATE) ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR;
+  m_file = ::open(t_path.c_str(), flags, 0644);
+  if (m_file < 0) throw(RunBitsetException::RuntimeBitsetFileError());
+#else
+  m_file = std::fopen(t_path.c_str(), (t_mode == READ) ? "rb" : (t_mode == CREATE) ? "w+b" : "r+b");
+  if (m_file == nullptr) throw(RunBitsetException::RuntimeBitsetFileError());
+#endif
+}
+
+RunBitset::PositionalFile::~PositionalFile() {
+#if defined(RUNBITSET_POSITIONAL_IO)
+  ::close(m_file);
+#else
+  std::fclose(m_file);
+#endif
+}
+
+void RunBitset::PositionalFile::readAt(const std::uint64_t t_offset, void* t_buffer, const std::size_t t_bytes) {
+#if defined(RUNBITSET_POSITIONAL_IO)
+  char* buffer = static_cast<char*>(t_buffer);
+  std::size_t done = 0;
+  while (done < t_bytes) { // pread can read less than asked
+    const ssize_t result = ::pread(m_file, buffer + done, t_bytes - done, static_cast<off_t>(t_offset + done));
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) throw(RunBitsetException::RuntimeBitsetFileError());
+    done += static_cast<std::size_t>(result);
+  }
+#else
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  if (std::fseek(m_file, static_cast<long>(t_offset), SEEK_SET) != 0 ||
+    std::fread(t_buffer, 1, t_bytes, m_file) != t_bytes) {
+    throw(RunBitsetException::RuntimeBitsetFileError());
+  }
+#endif
+}
+
+void RunBitset::PositionalFile::writeAt(const std::uint64_t t_offset, const void* t_buffer, const std::size_t t_bytes) {
+#if defined(RUNBITSET_POSITIONAL_IO)
+  const char* buffer = static_cast<const char*>(t_buffer);
+  std::size_t done = 0;
+  while (done < t_bytes) {
+    const ssize_t result = ::pwrite(m_file, buffer + done, t_bytes - done, static_cast<off_t>(t_offset + done));
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) throw(RunBitsetException::RuntimeBitsetFileError());
+    done += static_cast<std::size_t>(result);
+  }
+#else
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  if (std::fseek(m_file, static_cast<long>(t_offset), SEEK_SET) != 0 ||
+    std::fwrite(t_buffer, 1, t_bytes, m_file) != t_bytes) {
+    throw(RunBitsetException::RuntimeBitsetFileError());
+  }
+#endif
+}
+
+std::uint64_t RunBitset::PositionalFile::fileSize() {
+#if defined(RUNBITSET_POSITIONAL_IO)
+  const off_t size = ::lseek(m_file, 0, SEEK_END);
+  if (size < 0) throw(RunBitsetException::RuntimeBitsetFileError());
+  return static_cast<std::uint64_t>(size);
+#else
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  if (std::fseek(m_file, 0, SEEK_END) != 0) throw(RunBitsetException::RuntimeBitsetFileError());
+  return static_cast<std::uint64_t>(std::ftell(m_file));
+#endif
+}
+
+// Prepare the chunk i + 1 while the chunk i is being written
+void RunBitset::BitsetFile::save(const RuntimeBitset& t_bitset, const std::string& t_path) {
+  PositionalFile file(t_path, PositionalFile::CREATE);
+  const std::uint64_t header[HEADER_WORDS] = {toLittleEndian(MAGIC),
+    toLittleEndian(t_bitset.size()), toLittleEndian(t_bitset.blocks())};
+  file.writeAt(0, header, sizeof(header));
+  std::vector<std::size_t> buffers[2];
+  std::future<void> pending;
+  std::uint64_t hash = HASH_OFFSET;
+  const std::size_t* blocks = getBlocks(t_bitset);
+  for (std::size_t first = 0; first < t_bitset.blocks(); first += CHUNK_BLOCKS) {
+    const std::size_t count = std::min(CHUNK_BLOCKS, t_bitset.blocks() - first);
+    std::vector<std::size_t>& buffer = buffers[(first / CHUNK_BLOCKS) % 2];
+    buffer.assign(blocks + first, blocks + first + count);
+    buffer[count - 1] &= getMask(t_bitset, first + count - 1);
+    hash = checksum(hash, buffer.data(), count);
+    for (std::size_t& block : buffer) block = toLittleEndian(block);
+    if (pending.valid()) pending.get(); // the other buffer is free again
+    pending = std::async(std::launch::async, [&file, &buffer, first, count]() {
+      file.writeAt(blocksOffset(first), buffer.data(), count * sizeof(std::size_t));
+    });
+  }
+  if (pending.valid()) pending.get();
+  const std::uint64_t trailer = toLittleEndian(hash);
+  file.writeAt(blocksOffset(t_bitset.blocks()), &trailer, sizeof(trailer));
+}
+
+RunBitset::RuntimeBitset RunBitset::BitsetFile::load(const std::string& t_path) {
+  Loader loader(t_path);
+  return loader.release();
+}
+
+std::future<void> RunBitset::BitsetFile::saveAsync(const RuntimeBitset& t_bitset, const std::string& t_path) {
+  return std::async(std::launch::async, [&t_bitset, t_path]() {save(t_bitset, t_path);});
+}
+
+std::uint64_t RunBitset::BitsetFile::checksum
+(std::uint64_t t_hash, const std::size_t* t_blocks, const std::size_t t_count) noexcept {
+  for (std::size_t i = 0; i < t_count; ++i) {
+    t_hash = (t_hash ^ t_blocks[i]) * HASH_PRIME;
+  }
+  return t_hash;
+}
+
+std::uint64_t RunBitset::BitsetFile::toLittleEndian(const std::uint64_t t_word) noexcept {
+  if constexpr (std::endian::native == std::endian::little) return t_word;
+  std::uint64_t swapped = 0;
+  for (std::size_t i = 0; i < sizeof(t_word); ++i) {
+    swapped |= ((t_word >> (i * 8)) & 0xFF) << ((sizeof(t_word) - 1 - i) * 8);
+  }
+  return swapped;
+}
+
+std::size_t RunBitset::BitsetFile::getMask(const RuntimeBitset& t_bitset, const std::size_t t_block) noexcept {
+  return t_bitset.getMask(t_block);
+}
+
+void RunBitset::BitsetFile::refresh(RuntimeBitset& t_bitset) {
+  t_bitset.rebuildSummary(); // before recount, it uses the summary
+  t_bitset.recount();
+  t_bitset.markAllDirty();
+}
+
+std::uint64_t RunBitset::BitsetFile::blocksOffset(const std::size_t t_block) noexcept {
+  return (HEADER_WORDS + t_block) * sizeof(std::uint64_t);
+}
+
+std::size_t RunBitset::BitsetFile::readHeader(PositionalFile& t_file) {
+  std::uint64_t header[HEADER_WORDS];
+  const std::uint64_t fileSize = t_file.fileSize();
+  if (fileSize < sizeof(header)) throw(RunBitsetException::RuntimeBitsetInvalidFile());
+  t_file.readAt(0, header, sizeof(header));
+  const std::uint64_t size = toLittleEndian(header[1]);
+  const std::uint64_t blocks = toLittleEndian(header[2]);
+  if (toLittleEndian(header[0]) != MAGIC || size == 0 || blocks != (size + 63) / 64 ||
+    fileSize != blocksOffset(blocks) + sizeof(std::uint64_t)) {
+    throw(RunBitsetException::RuntimeBitsetInvalidFile());
+  }
+  return size;
+}
+
+// LOADER
+RunBitset::BitsetFile::Loader::Loader(const std::string& t_path)
+: m_file(t_path, PositionalFile::READ) {
+  m_bitset = RuntimeBitset(readHeader(m_file), uninitialized); // all the blocks are read
+  m_completion = m_promise.get_future().share();
+  m_thread = std::thread([this]() {run();});
+}
+
+RunBitset::BitsetFile::Loader::~Loader() {
+  m_stop.store(true, std::memory_order_relaxed);
+  if (m_thread.joinable()) m_thread.join();
+}
+
+std::size_t RunBitset::BitsetFile::Loader::loadedBits() const noexcept {
+  return std::min(m_loaded.load(std::memory_order_acquire) * RuntimeBitset::blockSize(), size());
+}
+
+bool RunBitset::BitsetFile::Loader::test(const std::size_t t_position) const {
+  if (t_position >= size()) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  waitFor(t_position / RuntimeBitset::blockSize() + 1);
+  return m_bitset.test(t_position);
+}
+
+RunBitset::RuntimeBitset& RunBitset::BitsetFile::Loader::get() {
+  m_completion.get();
+  return m_bitset;
+}
+
+RunBitset::RuntimeBitset RunBitset::BitsetFile::Loader::release() {
+  m_completion.get();
+  return std::move(m_bitset);
+}
+
+void RunBitset::BitsetFile::Loader::waitFor(const std::size_t t_blocks) const {
+  if (m_loaded.load(std::memory_order_acquire) >= t_blocks) return;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_condition.wait(lock, [&]() {
+    return m_loaded.load(std::memory_order_acquire) >= t_blocks || m_error != nullptr;
+  });
+  if (m_loaded.load(std::memory_order_acquire) < t_blocks) std::rethrow_exception(m_error);
+}
+
+// The chunk i + 1 is read (in another thread) while the chunk i is checked
+void RunBitset::BitsetFile::Loader::run() {
+  try {
+    std::size_t* blocks = getBlocks(m_bitset);
+    const std::size_t total = m_bitset.blocks();
+    auto read = [&](const std::size_t t_first) {
+      const std::size_t count = std::min(CHUNK_BLOCKS, total - t_first);
+      return std::async(std::launch::async, [this, blocks, t_first, count]() {
+        m_file.readAt(blocksOffset(t_first), blocks + t_first, count * sizeof(std::size_t));
+      });
+    };
+    std::uint64_t hash = HASH_OFFSET;
+    std::future<void> pending = read(0);
+    for (std::size_t first = 0; first < total; first += CHUNK_BLOCKS) {
+      pending.get();
+      const std::size_t count = std::min(CHUNK_BLOCKS, total - first);
+      if (first + count < total && !m_stop.load(std::memory_order_relaxed)) pending = read(first + count);
+      for (std::size_t i = first; i < first + count; ++i) {
+        blocks[i] = toLittleEndian(blocks[i]);
+      }
+      hash = checksum(hash, blocks + first, count);
+      {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_loaded.store(first + count, std::memory_order_release);
+      }
+      m_condition.notify_all();
+      if (m_stop.load(std::memory_order_relaxed)) throw(RunBitsetException::RuntimeBitsetLoadCancelled());
+    }
+    std::uint64_t trailer = 0;
+    m_file.readAt(blocksOffset(total), &trailer, sizeof(trailer));
+    if (toLittleEndian(trailer) != hash) throw(RunBitsetException::RuntimeBitsetInvalidFile());
+    refresh(m_bitset);
+    m_promise.set_value();
+  }
+  catch (...) {
+    {
+      const std::lock_guard<std::mutex> lock(m_mutex);
+      m_error = std::current_exception();
+    }
+    m_condition.notify_all();
+    m_promise.set_exception(m_error);
+  }
+}
@@ -0,0 +1,211 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, interface of the class ShardedBitsetAccumulator, a bitset set by several threads,
+ *   each one in its own shard, merged at the end
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace RunBitset {
+
+// Each thread sets its bits in its own shard, so there are no atomics or shared cache lines
+// A shard starts as a buffer of positions, and it becomes a RuntimeBitset when it has too many
+// finalize() merges all the shards with several threads, each one ORs a range of blocks of all of them
+// Example:
+//   ShardedBitsetAccumulator accumulator(size, threads);
+//   (in the thread i) accumulator.shard(i).set(position);
+//   RuntimeBitset result = accumulator.finalize();
+class ShardedBitsetAccumulator {
+  public:
+    // A shard becomes dense when it has more positions than blocks / DENSE_DIVISOR
+    //   (the buffer would use more than a quarter of the memory of a RuntimeBitset)
+    inline static constexpr std::size_t DENSE_DIVISOR = 4;
+
+    // Aligned, so two shards never share a cache line
+    class alignas(64) Shard {
+      public:
+        inline explicit Shard(const std::size_t t_size);
+
+        // Only one thread can use the same shard at the same time
+        inline void set(const std::size_t t_position);
+        inline bool isDense() const noexcept {return m_dense;}
+        // Positions in the buffer (with repetitions), 0 if it is dense
+        inline std::size_t bufferedPositions() const noexcept {return m_positions.size();}
+        inline void clear();
+
+      private:
+        friend class ShardedBitsetAccumulator;
+
+        inline void makeDense();
+
+        std::vector<std::size_t> m_positions; // while it is sparse
+        RuntimeBitset m_bitset; // only used when it is dense
+        std::size_t m_size = 0;
+        std::size_t m_limit = 0; // positions before it becomes dense
+        bool m_dense = false;
+    };
+
+    // With t_shards 0, one per hardware thread
+    inline explicit ShardedBitsetAccumulator(const std::size_t t_size, const std::size_t t_shards = 0);
+
+    inline Shard& shard(const std::size_t t_index);
+    inline std::size_t shards() const noexcept {return m_shards.size();}
+    inline std::size_t size() const noexcept {return m_size;}
+
+    // OR of all the shards, with t_threads threads (0 is one per hardware thread)
+    // The shards are not modified (only the order of their buffers), so more bits can be set after it
+    // No shard can be used by other threads meanwhile
+    inline RuntimeBitset finalize(const std::size_t t_threads = 0);
+    inline void clear();
+
+  private:
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    // More ranges than threads, so a thread with a slow range doesn´t delay all
+    inline static constexpr std::size_t RANGES_PER_THREAD = 4;
+    // The dense shards are ORed by pieces of MERGE_BLOCKS, so the result stays in the cache (32 KB)
+    inline static constexpr std::size_t MERGE_BLOCKS = 4096;
+
+    // PRIVATE METHODS
+    // Calls t_function(i) for each i in [0, t_count), with t_threads threads (this one included)
+    template<typename Function>
+    inline static void parallelFor(const std::size_t t_count, const std::size_t t_threads, Function t_function);
+    inline static std::size_t defaultThreads() noexcept;
+
+    // Attributes
+    std::vector<Shard> m_shards;
+    std::size_t m_size = 0;
+};
+
+} // namespace RunBitset
+
+
+// SHARD
+RunBitset::ShardedBitsetAccumulator::Shard::Shard(const std::size_t t_size) : m_size(t_size) {
+  if (t_size == 0) throw (RunBitsetException::RuntimeBitsetInvalidSize());
+  m_limit = (t_size + BLOCK_SIZE - 1) / BLOCK_SIZE / DENSE_DIVISOR;
+}
+
+void RunBitset::ShardedBitsetAccumulator::Shard::set(const std::size_t t_position) {
+  if (t_position >= m_size) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  if (m_dense) {
+    m_bitset.set(t_position);
+    return;
+  }
+  m_positions.push_back(t_position);
+  if (m_positions.size() > m_limit) makeDense();
+}
+
+void RunBitset::ShardedBitsetAccumulator::Shard::clear() {
+  m_positions = std::vector<std::size_t>(); // frees the memory too
+  m_bitset = RuntimeBitset();
+  m_dense = false;
+}
+
+void RunBitset::ShardedBitsetAccumulator::Shard::makeDense() {
+  m_bitset = RuntimeBitset(m_size);
+  for (const std::size_t position : m_positions) {
+    m_bitset.set(position);
+  }
+  m_positions = std::vector<std::size_t>();
+  m_dense = true;
+}
+
+// ACCUMULATOR
+RunBitset::ShardedBitsetAccumulator::ShardedBitsetAccumulator(const std::size_t t_size, const std::size_t t_shards)
+: m_size(t_size) {
+  const std::size_t shards = (t_shards == 0) ? defaultThreads() : t_shards;
+  m_shards.reserve(shards);
+  for (std::size_t i = 0; i < shards; ++i) {
+    m_shards.emplace_back(t_size);
+  }
+}
+
+RunBitset::ShardedBitsetAccumulator::Shard& RunBitset::ShardedBitsetAccumulator::shard(const std::size_t t_index) {
+  if (t_index >= m_shards.size()) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  return m_shards[t_index];
+}
+
+// The ranges of blocks are disjoint, so each block of the result is written by only one thread, and only once
+// The buffers are sorted first, so each range finds its positions with a binary search
+RunBitset::RuntimeBitset RunBitset::ShardedBitsetAccumulator::finalize(const std::size_t t_threads) {
+  const std::size_t threads = (t_threads == 0) ? defaultThreads() : t_threads;
+  std::vector<const std::size_t*> dense;
+  std::vector<Shard*> sparse;
+  for (Shard& current : m_shards) {
+    if (current.m_dense) dense.push_back(current.m_bitset.m_bits);
+    else if (!current.m_positions.empty()) sparse.push_back(&current);
+  }
+  parallelFor(sparse.size(), threads, [&](const std::size_t t_shard) {
+    std::sort(sparse[t_shard]->m_positions.begin(), sparse[t_shard]->m_positions.end());
+  });
+  // The first dense shard is copied, so the result only needs to be 0 without them
+  RuntimeBitset toReturn = dense.empty() ? RuntimeBitset(m_size) : RuntimeBitset(m_size, uninitialized);
+  std::size_t* result = toReturn.m_bits;
+  const std::size_t blocks = toReturn.blocks();
+  const std::size_t ranges = std::min(blocks, threads * RANGES_PER_THREAD);
+  parallelFor(ranges, threads, [&](const std::size_t t_range) {
+    const std::size_t first = blocks * t_range / ranges;
+    const std::size_t last = blocks * (t_range + 1) / ranges;
+    for (std::size_t begin = first; !dense.empty() && begin < last; begin += MERGE_BLOCKS) {
+      const std::size_t end = std::min(begin + MERGE_BLOCKS, last);
+      std::copy(dense[0] + begin, dense[0] + end, result + begin);
+      for (std::size_t k = 1; k < dense.size(); ++k) {
+        for (std::size_t i = begin; i < end; ++i) {
+          result[i] |= dense[k][i];
+        }
+      }
+    }
+    for (const Shard* current : sparse) {
+      const std::vector<std::size_t>& positions = current->m_positions;
+      auto position = std::lower_bound(positions.begin(), positions.end(), first * BLOCK_SIZE);
+      const auto stop = std::lower_bound(position, positions.end(), last * BLOCK_SIZE);
+      for (; position != stop; ++position) {
+        result[*position / BLOCK_SIZE] |= static_cast<std::size_t>(1) << (*position % BLOCK_SIZE);
+      }
+    }
+  });
+  // The blocks were written directly, update its count, summary...
+  toReturn.rebuildSummary();
+  toReturn.recount();
+  toReturn.markAllDirty();
+  return toReturn;
+}
+
+void RunBitset::ShardedBitsetAccumulator::clear() {
+  for (Shard& current : m_shards) {
+    current.clear();
+  }
+}
+
+template<typename Function>
+void RunBitset::ShardedBitsetAccumulator::parallelFor(const std::size_t t_count, const std::size_t t_threads, Function t_function) {
+  std::atomic<std::size_t> next{0};
+  auto work = [&]() {
+    for (std::size_t i = next.fetch_add(1, std::memory_order_relaxed); i < t_count; i = next.fetch_add(1, std::memory_order_relaxed)) {
+      t_function(i);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (std::size_t i = 1; i < std::min(t_threads, t_count); ++i) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+std::size_t RunBitset::ShardedBitsetAccumulator::defaultThreads() noexcept {
+  return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
@@ -0,0 +1,487 @@
+/**
+ * Author: TheLazyFerret (https://github.com/TheLazyFerret)
+ * Copyright (c) 2025 TheLazyFerret
+ * Licensed under the MIT License. See LICENSE file in the project root for full license information.
+ * header file, interface of the class SharedRuntimeBitset, represents
+ *   a bitset in POSIX shared memory, shared by several processes
+ */
+
+#pragma once
+
+#include "RuntimeBitset.hpp"
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+#if !defined(__unix__)
+#error "SharedRuntimeBitset needs POSIX shared memory (shm_open and mmap)"
+#endif
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace RunBitsetException {
+
+class RuntimeBitsetSharedMemoryError : public RuntimeBitsetException {
+  public:
+    RuntimeBitsetSharedMemoryError() : RuntimeBitsetException("Error creating, opening or mapping the shared memory") {}
+};
+
+class RuntimeBitsetInvalidSegment : public RuntimeBitsetException {
+  public:
+    RuntimeBitsetInvalidSegment() : RuntimeBitsetException("The shared memory is not a bitset or it is corrupted") {}
+  protected:
+    RuntimeBitsetInvalidSegment(const std::string& t_message) : RuntimeBitsetException(t_message) {}
+};
+
+class RuntimeBitsetStaleSegment : public RuntimeBitsetInvalidSegment {
+  public:
+    RuntimeBitsetStaleSegment() : RuntimeBitsetInvalidSegment("The creator of the shared memory didn´t finish it") {}
+};
+
+}
+
+namespace RunBitset {
+
+// Bitset in a shared memory segment (shm_open), every process that attaches to it maps the same blocks
+// The modifiers are atomic (std::atomic_ref), so several processes (and threads) can modify it at the same time
+// The reads of several blocks (count(), to_string()...) are not a snapshot if it is being modified
+// The segment lives until remove(), even when no process has it mapped
+// If the creator dies before writing the header, the segment stays there without it: attach() and
+//   openOrCreate() throw RuntimeBitsetStaleSegment after ATTACH_TIMEOUT, until someone removes it
+//   It is not removed here, two processes doing it at the same time could remove the new segment of the other
+// With glibc older than 2.34, link with -lrt
+class SharedRuntimeBitset {
+  public:
+    // New segment, RuntimeBitsetSharedMemoryError if it already exists
+    inline static SharedRuntimeBitset create(const std::string& t_name, const std::size_t t_size);
+    // Existing segment, the header is checked (RuntimeBitsetInvalidSegment, RuntimeBitsetStaleSegment if it was never finished)
+    inline static SharedRuntimeBitset attach(const std::string& t_name);
+    // Attach if it exists (RuntimeBitsetSizeDismatch if the size is not t_size), create it if not
+    inline static SharedRuntimeBitset openOrCreate(const std::string& t_name, const std::size_t t_size);
+    // Delete the segment, the processes with it mapped can still use it. False if it doesn´t exist
+    inline static bool remove(const std::string& t_name) noexcept;
+
+    // SPECIAL MEMBERS
+    inline ~SharedRuntimeBitset(); // unmap, the segment is not deleted
+    SharedRuntimeBitset(const SharedRuntimeBitset&) = delete;
+    SharedRuntimeBitset& operator=(const SharedRuntimeBitset&) = delete;
+    inline SharedRuntimeBitset(SharedRuntimeBitset&& t_SharedRuntimeBitset) noexcept; // Move constructor
+    inline SharedRuntimeBitset& operator=(SharedRuntimeBitset&& t_SharedRuntimeBitset) noexcept; // Move assignment
+
+    inline std::string to_string() const;
+    inline RuntimeBitset toRuntimeBitset() const;
+
+    // NORMAL MEMBERS
+    inline bool operator[](std::size_t t_position) const;
+    inline bool test(std::size_t t_position) const;
+
+    inline bool all() const noexcept;
+    inline bool any() const noexcept;
+    inline bool none() const noexcept;
+
+    inline std::size_t count() const noexcept;
+
+    // Find the first active bit starting in t_position, returns size() if there isn´t any
+    inline std::size_t find_first() const noexcept;
+    inline std::size_t find_next(const std::size_t t_position) const noexcept;
+
+    // Capacity
+    inline std::size_t size() const noexcept {return m_size;}
+    inline std::size_t blocks() const noexcept {return m_blocks;}
+    inline const std::string& name() const noexcept {return m_name;}
+
+    inline std::size_t getBlock(const std::size_t t_block) const;
+
+    // Modifiers, each block is modified atomically
+    inline SharedRuntimeBitset& set() noexcept;
+    inline SharedRuntimeBitset& set(const std::size_t t_position);
+    inline SharedRuntimeBitset& reset() noexcept;
+    inline SharedRuntimeBitset& reset(const std::size_t t_position);
+    inline SharedRuntimeBitset& flip() noexcept;
+    inline SharedRuntimeBitset& flip(const std::size_t t_position);
+
+    // Set (or reset) the bit and return its old value, only one process gets false for the same bit
+    inline bool testAndSet(const std::size_t t_position);
+    inline bool testAndReset(const std::size_t t_position);
+
+    inline SharedRuntimeBitset& operator&=(const RuntimeBitset& t_other);
+    inline SharedRuntimeBitset& operator|=(const RuntimeBitset& t_other);
+    inline SharedRuntimeBitset& operator^=(const RuntimeBitset& t_other);
+
+  private:
+    // Only the lock free atomics work between processes
+    static_assert(std::atomic_ref<std::size_t>::is_always_lock_free, "the blocks must be lock free atomics");
+    static_assert(std::atomic_ref<std::uint64_t>::is_always_lock_free, "the header must be lock free atomics");
+
+    // STATIC MEMBERS
+    inline static constexpr std::size_t BLOCK_SIZE = RuntimeBitset::blockSize();
+    inline static constexpr std::size_t ALL_BITS_ONE = ~static_cast<std::size_t>(0);
+    inline static constexpr std::uint64_t MAGIC = 0x4d4853544942554e; // "NUBITSHM"
+    inline static constexpr std::uint64_t VERSION = 1;
+    // Time waiting for the creator to finish the segment
+    inline static constexpr std::chrono::milliseconds ATTACH_TIMEOUT{1000};
+
+    // At the start of the segment, the blocks go after it (in their own cache line)
+    // The magic is written the last one, when the rest is ready
+    struct Header {
+      std::uint64_t magic;
+      std::uint64_t version;
+      std::uint64_t size;
+      std::uint64_t blocks;
+      std::uint64_t reserved[4];
+    };
+    static_assert(sizeof(Header) == 64, "the header must be a cache line");
+
+    // PRIVATE METHODS
+    inline SharedRuntimeBitset() = default; // only for create() and attach()
+    // Returns false if the segment already exists
+    inline bool tryCreate(const std::string& t_name, const std::size_t t_size);
+    inline void attachTo(const std::string& t_name);
+    inline void destroy() noexcept;
+    inline static std::string segmentName(const std::string& t_name);
+    inline std::atomic_ref<std::size_t> block(const std::size_t t_block) const noexcept;
+    inline std::size_t getMask(const std::size_t t_block) const noexcept;
+    inline void checkPosition(const std::size_t t_position) const;
+    inline void checkSize(const RuntimeBitset& t_other) const;
+
+    // Attributes
+    std::string m_name;
+    void* m_memory = nullptr;
+    std::size_t m_length = 0; // bytes mapped
+    std::size_t* m_bits = nullptr;
+    std::size_t m_size = 0;
+    std::size_t m_blocks = 0;
+    std::size_t m_lastMask = 0; // mask of the most significant block
+};
+
+} // namespace RunBitset
+
+
+RunBitset::SharedRuntimeBitset RunBitset::SharedRuntimeBitset::create(const std::string& t_name, const std::size_t t_size) {
+  SharedRuntimeBitset toReturn;
+  if (!toReturn.tryCreate(t_name, t_size)) throw(RunBitsetException::RuntimeBitsetSharedMemoryError());
+  return toReturn;
+}
+
+RunBitset::SharedRuntimeBitset RunBitset::SharedRuntimeBitset::attach(const std::string& t_name) {
+  SharedRuntimeBitset toReturn;
+  toReturn.attachTo(t_name);
+  return toReturn;
+}
+
+RunBitset::SharedRuntimeBitset RunBitset::SharedRuntimeBitset::openOrCreate(const std::string& t_name, const std::size_t t_size) {
+  SharedRuntimeBitset toReturn;
+  if (toReturn.tryCreate(t_name, t_size)) return toReturn;
+  toReturn.attachTo(t_name); // another process created it first
+  if (toReturn.m_size != t_size) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+  return toReturn;
+}
+
+bool RunBitset::SharedRuntimeBitset::remove(const std::string& t_name) noexcept {
+  try {
+    return ::shm_unlink(segmentName(t_name).c_str()) == 0;
+  }
+  catch (...) { // the name couldn´t be allocated
+    return false;
+  }
+}
+
+RunBitset::SharedRuntimeBitset::~SharedRuntimeBitset() {
+  destroy();
+}
+
+RunBitset::SharedRuntimeBitset::SharedRuntimeBitset(SharedRuntimeBitset&& t_SharedRuntimeBitset) noexcept
+: m_name(std::move(t_SharedRuntimeBitset.m_name)), m_memory(t_SharedRuntimeBitset.m_memory),
+  m_length(t_SharedRuntimeBitset.m_length), m_bits(t_SharedRuntimeBitset.m_bits),
+  m_size(t_SharedRuntimeBitset.m_size), m_blocks(t_SharedRuntimeBitset.m_blocks),
+  m_lastMask(t_SharedRuntimeBitset.m_lastMask) {
+  t_SharedRuntimeBitset.m_memory = nullptr;
+  t_SharedRuntimeBitset.m_bits = nullptr;
+  t_SharedRuntimeBitset.m_length = 0;
+  t_SharedRuntimeBitset.m_size = 0;
+  t_SharedRuntimeBitset.m_blocks = 0;
+}
+
+RunBitset::SharedRuntimeBitset& RunBitset::SharedRuntimeBitset::operator=(SharedRuntimeBitset&& t_SharedRuntimeBitset) noexcept {
+  if (this == &t_SharedRuntimeBitset) return *this;
+  destroy();
+  m_name = std::move(t_SharedRuntimeBitset.m_name);
+  m_memory = t_SharedRuntimeBitset.m_memory;
+  m_length = t_SharedRuntimeBitset.m_length;
+  m_bits = t_SharedRuntimeBitset.m_bits;
+  m_size = t_SharedRuntimeBitset.m_size;
+  m_blocks = t_SharedRuntimeBitset.m_blocks;
+  m_lastMask = t_SharedRuntimeBitset.m_lastMask;
+  t_SharedRuntimeBitset.m_memory = nullptr;
+  t_SharedRuntimeBitset.m_bits = nullptr;
+  t_SharedRuntimeBitset.m_length = 0;
+  t_SharedRuntimeBitset.m_size = 0;
+  t_SharedRuntimeBitset.m_blocks = 0;
+  return *this;
+}
+
+std::string RunBitset::SharedRuntimeBitset::to_string() const {
+  std::string toReturn(m_size, '0');
+  for (std::size_t i = find_first(); i < m_size; i = find_next(i + 1)) {
+    toReturn[m_size - 1 - i] = '1'; // the most significant bit is the first character
+  }
+  return toReturn;
+}
+
+RunBitset::RuntimeBitset RunBitset::SharedRuntimeBitset::toRuntimeBitset() const {
+  RuntimeBitset toReturn(m_size);
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    const std::size_t value = block(i).load(std::memory_order_acquire);
+    if (value != 0) toReturn.setBlock(i, value);
+  }
+  return toReturn;
+}
+
+bool RunBitset::SharedRuntimeBitset::operator[](std::size_t t_position) const {
+  return test(t_position);
+}
+
+bool RunBitset::SharedRuntimeBitset::test(std::size_t t_position) const {
+  checkPosition(t_position);
+  return (block(t_position / BLOCK_SIZE).load(std::memory_order_acquire) >> (t_position % BLOCK_SIZE)) & 1;
+}
+
+bool RunBitset::SharedRuntimeBitset::all() const noexcept {
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    if (block(i).load(std::memory_order_acquire) != getMask(i)) return false;
+  }
+  return true;
+}
+
+bool RunBitset::SharedRuntimeBitset::any() const noexcept {
+  return find_first() != m_size;
+}
+
+bool RunBitset::SharedRuntimeBitset::none() const noexcept {
+  return find_first() == m_size;
+}
+
+std::size_t RunBitset::SharedRuntimeBitset::count() const noexcept {
+  std::size_t numberOfActive = 0;
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    numberOfActive += std::popcount(block(i).load(std::memory_order_relaxed));
+  }
+  return numberOfActive;
+}
+
+std::size_t RunBitset::SharedRuntimeBitset::find_first() const noexcept {
+  return find_next(0);
+}
+
+std::size_t RunBitset::SharedRuntimeBitset::find_next(const std::size_t t_position) const noexcept {
+  if (t_position >= m_size) return m_size;
+  std::size_t current = t_position / BLOCK_SIZE;
+  // Rest of the block of t_position
+  const std::size_t first = block(current).load(std::memory_order_acquire) & (ALL_BITS_ONE << (t_position % BLOCK_SIZE));
+  if (first != 0) return current * BLOCK_SIZE + std::countr_zero(first);
+  for (++current; current < m_blocks; ++current) {
+    const std::size_t value = block(current).load(std::memory_order_acquire);
+    if (value != 0) return current * BLOCK_SIZE + std::countr_zero(value);
+  }
+  return m_size;
+}
+
+std::size_t RunBitset::SharedRuntimeBitset::getBlock(const std::size_t t_block) const {
+  if (t_block >= m_blocks) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+  return block(t_block).load(std::memory_order_acquire);
+}
+
+RunBitset::SharedRuntimeBitset& RunBitset::SharedRuntimeBitset::set() noexcept {
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    block(i).store(getMask(i), std::memory_order_release);
+  }
+  return *this;
+}
+
+RunBitset::SharedRuntimeBitset& RunBitset::SharedRuntimeBitset::set(const std::size_t t_position) {
+  testAndSet(t_position);
+  return *this;
+}
+
+RunBitset::SharedRuntimeBitset& RunBitset::SharedRuntimeBitset::reset() noexcept {
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    block(i).store(0, std::memory_order_release);
+  }
+  return *this;
+}
+
+RunBitset::SharedRuntimeBitset& RunBitset::SharedRuntimeBitset::reset(const std::size_t t_position) {
+  testAndReset(t_position);
+  return *this;
+}
+
+RunBitset::SharedRuntimeBitset& RunBitset::SharedRuntimeBitset::flip() noexcept {
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    block(i).fetch_xor(getMask(i), std::memory_order_acq_rel);
+  }
+  return *this;
+}
+
+RunBitset::SharedRuntimeBitset& RunBitset::SharedRuntimeBitset::flip(const std::size_t t_position) {
+  checkPosition(t_position);
+  block(t_position / BLOCK_SIZE).fetch_xor(static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE), std::memory_order_acq_rel);
+  return *this;
+}
+
+bool RunBitset::SharedRuntimeBitset::testAndSet(const std::size_t t_position) {
+  checkPosition(t_position);
+  const std::size_t bit = static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE);
+  return (block(t_position / BLOCK_SIZE).fetch_or(bit, std::memory_order_acq_rel) & bit) != 0;
+}
+
+bool RunBitset::SharedRuntimeBitset::testAndReset(const std::size_t t_position) {
+  checkPosition(t_position);
+  const std::size_t bit = static_cast<std::size_t>(1) << (t_position % BLOCK_SIZE);
+  return (block(t_position / BLOCK_SIZE).fetch_and(~bit, std::memory_order_acq_rel) & bit) != 0;
+}
+
+// The blocks of 0 of t_other (or 1 for &=) don´t change anything, they are skipped
+RunBitset::SharedRuntimeBitset& RunBitset::SharedRuntimeBitset::operator&=(const RuntimeBitset& t_other) {
+  checkSize(t_other);
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    const std::size_t value = t_other.getBlock(i) | ~getMask(i);
+    if (value != ALL_BITS_ONE) block(i).fetch_and(value, std::memory_order_acq_rel);
+  }
+  return *this;
+}
+
+RunBitset::SharedRuntimeBitset& RunBitset::SharedRuntimeBitset::operator|=(const RuntimeBitset& t_other) {
+  checkSize(t_other);
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    const std::size_t value = t_other.getBlock(i) & getMask(i);
+    if (value != 0) block(i).fetch_or(value, std::memory_order_acq_rel);
+  }
+  return *this;
+}
+
+RunBitset::SharedRuntimeBitset& RunBitset::SharedRuntimeBitset::operator^=(const RuntimeBitset& t_other) {
+  checkSize(t_other);
+  for (std::size_t i = 0; i < m_blocks; ++i) {
+    const std::size_t value = t_other.getBlock(i) & getMask(i);
+    if (value != 0) block(i).fetch_xor(value, std::memory_order_acq_rel);
+  }
+  return *this;
+}
+
+// The size is fixed with ftruncate (so the blocks are 0) before the header is written
+bool RunBitset::SharedRuntimeBitset::tryCreate(const std::string& t_name, const std::size_t t_size) {
+  // Bitsets of size 0 breaks the implementation
+  if (t_size == 0) throw (RunBitsetException::RuntimeBitsetInvalidSize());
+  const std::string name = segmentName(t_name);
+  const int file = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (file < 0 && errno == EEXIST) return false;
+  if (file < 0) throw(RunBitsetException::RuntimeBitsetSharedMemoryError());
+  const std::size_t blocks = (t_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  const std::size_t length = sizeof(Header) + blocks * sizeof(std::size_t);
+  void* memory = MAP_FAILED;
+  if (::ftruncate(file, static_cast<off_t>(length)) == 0) {
+    memory = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  }
+  ::close(file); // the mapping doesn´t need it
+  if (memory == MAP_FAILED) {
+    ::shm_unlink(name.c_str()); // don´t leave a segment without header
+    throw(RunBitsetException::RuntimeBitsetSharedMemoryError());
+  }
+  m_name = name;
+  m_memory = memory;
+  m_length = length;
+  m_bits = reinterpret_cast<std::size_t*>(static_cast<char*>(memory) + sizeof(Header));
+  m_size = t_size;
+  m_blocks = blocks;
+  m_lastMask = ALL_BITS_ONE >> (m_blocks * BLOCK_SIZE - m_size);
+  Header* header = static_cast<Header*>(memory);
+  header->version = VERSION;
+  header->size = t_size;
+  header->blocks = blocks;
+  std::atomic_ref<std::uint64_t>(header->magic).store(MAGIC, std::memory_order_release);
+  return true;
+}
+
+// The creator can be between shm_open and ftruncate, or writing the header, so it waits a bit
+void RunBitset::SharedRuntimeBitset::attachTo(const std::string& t_name) {
+  const std::string name = segmentName(t_name);
+  const int file = ::shm_open(name.c_str(), O_RDWR, 0);
+  if (file < 0) throw(RunBitsetException::RuntimeBitsetSharedMemoryError());
+  const auto deadline = std::chrono::steady_clock::now() + ATTACH_TIMEOUT;
+  struct stat info;
+  while (true) {
+    if (::fstat(file, &info) != 0) {
+      ::close(file);
+      throw(RunBitsetException::RuntimeBitsetSharedMemoryError());
+    }
+    if (static_cast<std::size_t>(info.st_size) >= sizeof(Header)) break;
+    if (std::chrono::steady_clock::now() >= deadline) {
+      ::close(file);
+      throw(RunBitsetException::RuntimeBitsetStaleSegment()); // the creator died before ftruncate
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const std::size_t length = static_cast<std::size_t>(info.st_size);
+  void* memory = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  ::close(file);
+  if (memory == MAP_FAILED) throw(RunBitsetException::RuntimeBitsetSharedMemoryError());
+  m_name = name;
+  m_memory = memory;
+  m_length = length;
+  Header* header = static_cast<Header*>(memory);
+  std::uint64_t magic;
+  while ((magic = std::atomic_ref<std::uint64_t>(header->magic).load(std::memory_order_acquire)) == 0) {
+    if (std::chrono::steady_clock::now() >= deadline) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  // The destructor unmaps it if it is not valid
+  // ftruncate fills it with 0, without magic nor size the creator died before writing the header
+  if (magic == 0 && header->size == 0) throw(RunBitsetException::RuntimeBitsetStaleSegment());
+  if (magic != MAGIC || header->version != VERSION || header->size == 0 ||
+    header->blocks != (header->size + BLOCK_SIZE - 1) / BLOCK_SIZE ||
+    length < sizeof(Header) + header->blocks * sizeof(std::size_t)) {
+    throw(RunBitsetException::RuntimeBitsetInvalidSegment());
+  }
+  m_bits = reinterpret_cast<std::size_t*>(static_cast<char*>(memory) + sizeof(Header));
+  m_size = header->size;
+  m_blocks = header->blocks;
+  m_lastMask = ALL_BITS_ONE >> (m_blocks * BLOCK_SIZE - m_size);
+}
+
+void RunBitset::SharedRuntimeBitset::destroy() noexcept {
+  if (m_memory != nullptr) ::munmap(m_memory, m_length);
+  m_memory = nullptr;
+  m_bits = nullptr;
+  m_length = 0;
+}
+
+// shm_open wants a name like "/name"
+std::string RunBitset::SharedRuntimeBitset::segmentName(const std::string& t_name) {
+  return (!t_name.empty() && t_name[0] == '/') ? t_name : "/" + t_name;
+}
+
+std::atomic_ref<std::size_t> RunBitset::SharedRuntimeBitset::block(const std::size_t t_block) const noexcept {
+  return std::atomic_ref<std::size_t>(m_bits[t_block]);
+}
+
+std::size_t RunBitset::SharedRuntimeBitset::getMask(const std::size_t t_block) const noexcept {
+  return (t_block == m_blocks - 1) ? m_lastMask : ALL_BITS_ONE;
+}
+
+void RunBitset::SharedRuntimeBitset::checkPosition(const std::size_t t_position) const {
+  if (t_position >= m_size) throw(RunBitsetException::RuntimeBitsetOutOfRange());
+}
+
+void RunBitset::SharedRuntimeBitset::checkSize(const RuntimeBitset& t_other) const {
+  if (m_size != t_other.size()) throw(RunBitsetException::RuntimeBitsetSizeDismatch());
+}
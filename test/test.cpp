@@ -2,26 +2,1460 @@
  * Author: TheLazyFerret (https://github.com/TheLazyFerret)
  * Copyright (c) 2025 TheLazyFerret
  * Licensed under the MIT License. See LICENSE file in the project root for full license information.
- * 
+ *
  * test file used for testing RuntimeBitset
  */
 
 
-// g++ -Wall -Wextra -Werror -I lib/ -g lib/RuntimeBitset/RuntimeBitset.cpp test/test.cpp
+// g++ -std=c++20 -Wall -Wextra -Werror -pedantic -I lib/ -g test/test.cpp -o runtimebitset_test -pthread
 
 #include "RuntimeBitset/RuntimeBitset.hpp"
+#include "RuntimeBitset/RuntimeBitsetIO.hpp"
+#include "RuntimeBitset/BitsetCombiner.hpp"
+#include "RuntimeBitset/SharedRuntimeBitset.hpp"
+#include "RuntimeBitset/ShardedBitsetAccumulator.hpp"
+#include "RuntimeBitset/PagedBitset.hpp"
+#include "RuntimeBitset/PersistentBitset.hpp"
+#include "RuntimeBitset/DiskBitset.hpp"
+#include "RuntimeBitset/EwahBitset.hpp"
+#include "RuntimeBitset/IdAllocator.hpp"
+#include "RuntimeBitset/HammingIndex.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iomanip>
 #include <iostream>
-#include <bitset>
+#include <iterator>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-using namespace DynBitset;
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
 
-int main() {
+using namespace RunBitset;
+
+// Number of allocations before one fails, -1 to never fail
+// Used to test that a failed copy doesn´t modify the target
+namespace {
+std::atomic<long> allocationsUntilFailure{-1};
+}
+
+void* operator new(std::size_t t_bytes) {
+  long remaining = allocationsUntilFailure.load();
+  while (remaining > 0 && !allocationsUntilFailure.compare_exchange_weak(remaining, remaining - 1)) {}
+  if (remaining == 0) throw(std::bad_alloc());
+  void* memory = std::malloc(t_bytes != 0 ? t_bytes : 1);
+  if (memory == nullptr) throw(std::bad_alloc());
+  return memory;
+}
+
+void* operator new(std::size_t t_bytes, const std::nothrow_t&) noexcept {
+  try {
+    return operator new(t_bytes);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+// The memory of operator new comes from malloc, but GCC doesn´t know it when they are inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* t_memory) noexcept {std::free(t_memory);}
+void operator delete(void* t_memory, std::size_t) noexcept {std::free(t_memory);}
+#pragma GCC diagnostic pop
+
+namespace {
+
+void testReference() {
   RuntimeBitset one(70, ~0);
   RuntimeBitset::Reference ref = one[15];
   ref.flip();
-  std::cout << ref << std::endl;
+  assert(!ref && !one.test(15));
   one[10] = false;
-  std::cout << one << std::endl;
+  assert(!one.test(10) && one.test(11));
+  assert(one.count() == 62); // only the first 64 bits from the number, 2 of them reset
+}
+
+// ~ of a bitset that is not a temporary is a view, of a temporary it is a new bitset (the view would dangle)
+void testComplementView() {
+  const RuntimeBitset bitset(std::string("0011"));
+  const auto view = ~bitset;
+  static_assert(std::is_same_v<std::remove_const_t<decltype(view)>, RuntimeBitset::ComplementView>);
+  assert(view.to_string() == "1100" && view.count() == 2);
+  assert(view.find_first() == 2 && view.find_next(3) == 3 && view.find_next(4) == 4);
+  assert((~bitset).find_first() == 2);
+
+  auto complemented = ~RuntimeBitset(std::string("0011"));
+  static_assert(std::is_same_v<decltype(complemented), RuntimeBitset>);
+  assert(complemented.to_string() == "1100");
+  auto fromExpression = ~(bitset & bitset);
+  static_assert(std::is_same_v<decltype(fromExpression), RuntimeBitset>);
+  assert(fromExpression.to_string() == "1100");
+  const RuntimeBitset& constTemporary = ~std::move(bitset); // const&&, copied
+  assert(constTemporary.to_string() == "1100" && bitset.to_string() == "0011");
+
+  // The modifiers of a view return a new bitset, the viewed one is not modified
+  assert((~bitset).flip().to_string() == "0011");
+  assert((~bitset).set(0).to_string() == "1101");
+  assert((~bitset).reset().none());
+  assert(bitset.to_string() == "0011");
+}
+
+// Same for the shifts, and the views can be combined without copying the bitset
+void testShiftView() {
+  const RuntimeBitset bitset(std::string("0011"));
+  const auto view = bitset << 1;
+  static_assert(std::is_same_v<std::remove_const_t<decltype(view)>, RuntimeBitset::ShiftView>);
+  assert(view.to_string() == "0110" && view.find_first() == 1 && view.find_next(3) == 4);
+  assert((bitset >> 1).to_string() == "0001");
+  assert(((bitset << 3) >> 2).to_string() == "0010"); // the bits shifted out are lost
+
+  // The complement of a shift is 1 in the positions shifted in, like ~(bitset << 1) of a bitset
+  assert((~(bitset << 1)).to_string() == "1001");
+  assert((~(bitset << 1)).count() == 2 && (~(bitset << 1)).find_first() == 0);
+  auto shiftedComplement = ~bitset << 1;
+  assert(shiftedComplement.to_string() == "1000");
+  assert(((~(bitset << 1)) << 1).to_string() == "0010"); // materialized by the view
+
+  auto shifted = RuntimeBitset(std::string("0011")) << 1;
+  static_assert(std::is_same_v<decltype(shifted), RuntimeBitset>);
+  assert(shifted.to_string() == "0110");
+  // Multiples of the block size only move blocks
+  assert((RuntimeBitset(130, ~0) >> 64).none());
+  assert((RuntimeBitset(130, ~0) << 64).count() == 64 && (RuntimeBitset(130, ~0) << 64).find_first() == 64);
+
+  assert((bitset << 1).set(0).to_string() == "0111");
+  assert((bitset >> 1).flip().to_string() == "1110");
+  assert(bitset.to_string() == "0011");
+}
+
+// count() with the cached count is the same as without it, after every kind of modifier
+void testCountCache() {
+  std::mt19937_64 generator(13);
+  for (const std::size_t size : {1ul, 63ul, 64ul, 65ul, 1000ul, 5003ul}) {
+    RuntimeBitset cached(size), plain(size);
+    cached.enableCountCache();
+    auto randomBitset = [&generator, size]() {
+      RuntimeBitset bitset(size);
+      for (std::size_t i = 0; i < size; ++i) if (generator() % 3 == 0) bitset.set(i);
+      return bitset;
+    };
+    for (int i = 0; i < 300; ++i) {
+      const std::size_t position = generator() % size;
+      const std::size_t shift = generator() % (size + 2);
+      const RuntimeBitset other = randomBitset();
+      switch (generator() % 18) {
+        case 0: cached.set(position); plain.set(position); break;
+        case 1: cached.reset(position); plain.reset(position); break;
+        case 2: cached.flip(position); plain.flip(position); break;
+        case 3: cached[position] = true; plain[position] = true; break;
+        case 4: cached.set(); plain.set(); break;
+        case 5: cached.reset(); plain.reset(); break;
+        case 6: cached.flip(); plain.flip(); break;
+        case 7: cached &= other; plain &= other; break;
+        case 8: cached |= other; plain |= other; break;
+        case 9: cached ^= other; plain ^= other; break;
+        case 10: cached &= ~other; plain &= ~other; break;
+        case 11: cached |= other << shift; plain |= other << shift; break;
+        case 12: cached <<= shift; plain <<= shift; break;
+        case 13: cached >>= shift; plain >>= shift; break;
+        case 14: cached = other; plain = other; break; // the copy keeps the cache of the target
+        case 15: cached.setBlock(position / RuntimeBitset::blockSize(), generator()); 
+          plain.setBlock(position / RuntimeBitset::blockSize(), cached.getBlock(position / RuntimeBitset::blockSize())); 
+          break;
+        case 16: apply_patch(cached, diff(cached, other)); plain = other; break;
+        default: { // a copy of a cached bitset, and back
+          RuntimeBitset copy(size);
+          copy.enableCountCache();
+          copy = cached;
+          cached = std::move(copy);
+          break;
+        }
+      }
+      assert(cached.isCountCached() && cached.count() == plain.count());
+      assert(cached.to_string() == plain.to_string());
+    }
+    cached.disableCountCache();
+    assert(cached.count() == plain.count());
+  }
+}
+
+// any(), none(), count(), find and & with the summary skip the empty blocks, and give the same as without it
+void testSummary() {
+  // Very sparse: a few bits in 16M
+  constexpr std::size_t BIG_SIZE = 1ul << 24;
+  RuntimeBitset sparse(BIG_SIZE);
+  sparse.enableSummary();
+  assert(sparse.hasSummary() && sparse.none() && !sparse.any() && sparse.find_first() == BIG_SIZE);
+  const std::vector<std::size_t> positions = {5, 64 * 4096 + 3, 9000000, BIG_SIZE - 1};
+  for (const std::size_t position : positions) sparse.set(position);
+  assert(sparse.any() && sparse.count() == positions.size() && sparse.find_first() == 5);
+  for (std::size_t i = 0; i + 1 < positions.size(); ++i) {
+    assert(sparse.find_next(positions[i] + 1) == positions[i + 1]);
+  }
+  RuntimeBitset other(BIG_SIZE);
+  other.set(9000000).set(7);
+  assert((sparse & other).count() == 1 && (sparse & other).find_first() == 9000000);
+  assert((other & sparse).find_first() == 9000000);
+  sparse.reset(9000000);
+  assert(sparse.find_next(64 * 4096 + 4) == BIG_SIZE - 1 && sparse.count() == 3);
+  sparse.flip();
+  assert(sparse.count() == BIG_SIZE - 3 && sparse.find_first() == 0 && sparse.find_next(5) == 6);
+  sparse.reset();
+  assert(sparse.none() && sparse.find_first() == BIG_SIZE);
+  sparse |= other;
+  assert(sparse.count() == 2 && sparse.find_first() == 7);
+  sparse <<= 64 * 100;
+  assert(sparse.find_first() == 7 + 64 * 100 && sparse.find_next(7 + 64 * 100 + 1) == 9000000 + 64 * 100);
+  sparse.set();
+  assert(sparse.count() == BIG_SIZE);
+
+  // The same random operations with and without summary
+  std::mt19937_64 generator(17);
+  for (const std::size_t size : {1ul, 64ul, 65ul, 4096ul, 4097ul, 70001ul}) {
+    RuntimeBitset summarized(size), plain(size);
+    summarized.enableSummary();
+    auto randomBitset = [&generator, size]() {
+      RuntimeBitset bitset(size);
+      // Sparse, so there are empty blocks and empty words of the summary
+      for (int i = 0; i < 5; ++i) bitset.set(generator() % size);
+      return bitset;
+    };
+    for (int i = 0; i < 200; ++i) {
+      const std::size_t position = generator() % size;
+      const RuntimeBitset other = randomBitset();
+      switch (generator() % 12) {
+        case 0: case 1: summarized.set(position); plain.set(position); break;
+        case 2: summarized.reset(position); plain.reset(position); break;
+        case 3: summarized.flip(position); plain.flip(position); break;
+        case 4: summarized &= other | summarized; plain &= other | plain; break;
+        case 5: summarized |= other; plain |= other; break;
+        case 6: summarized ^= other; plain ^= other; break;
+        case 7: summarized <<= position; plain <<= position; break;
+        case 8: summarized >>= position; plain >>= position; break;
+        case 9: summarized = other; plain = other; break;
+        case 10: summarized &= ~other; plain &= ~other; break;
+        default: 
+          if (generator() % 4 == 0) {summarized.reset(); plain.reset();}
+          break;
+      }
+      assert(summarized.hasSummary());
+      assert(summarized.any() == plain.any() && summarized.none() == plain.none());
+      assert(summarized.count() == plain.count() && summarized.find_first() == plain.find_first());
+      assert(summarized.find_next(position) == plain.find_next(position));
+      RuntimeBitset otherSummarized = other;
+      otherSummarized.enableSummary();
+      assert((summarized & otherSummarized).to_string() == (plain & other).to_string());
+      assert((summarized & other).count() == (plain & other).count());
+    }
+    assert(summarized.to_string() == plain.to_string());
+  }
+}
+
+// Only the pages with active bits are allocated, and the operations give the same as RuntimeBitset
+void testPagedBitset() {
+  constexpr std::size_t PAGE_BITS = PagedBitset::PAGE_BLOCKS * RuntimeBitset::blockSize();
+  const std::size_t size = PAGE_BITS * 10 + 77; // 11 pages, the last one shorter
+  PagedBitset paged(size);
+  assert(paged.pages() == 11 && paged.allocatedPages() == 0 && paged.none());
+  assert(!paged.test(PAGE_BITS * 3) && paged.allocatedPages() == 0); // reading doesn´t allocate
+  paged.set(5).set(PAGE_BITS * 4 + 1).set(PAGE_BITS * 4 + 900).set(size - 1);
+  assert(paged.allocatedPages() == 3 && paged.count() == 4);
+  assert(paged.find_first() == 5 && paged.find_next(6) == PAGE_BITS * 4 + 1 && paged.find_next(PAGE_BITS * 5) == size - 1);
+  paged.reset(PAGE_BITS * 7); // already 0, nothing to allocate
+  assert(paged.allocatedPages() == 3);
+  // The pages that go back to 0 are freed, there is nothing left for reclaim()
+  paged.reset(PAGE_BITS * 4 + 1).flip(PAGE_BITS * 4 + 900);
+  assert(paged.allocatedPages() == 2 && paged.reclaim() == 0);
+  PagedBitset other(size);
+  other.set(5);
+  paged &= other;
+  assert(paged.allocatedPages() == 1 && paged.count() == 1 && paged.reclaim() == 0);
+  paged.set();
+  assert(paged.all() && paged.allocatedPages() == 11 && paged.count() == size);
+  paged.flip();
+  assert(paged.none() && paged.allocatedPages() == 0);
+
+  // The same random operations in a PagedBitset and in a RuntimeBitset
+  std::mt19937_64 generator(19);
+  auto sameBits = [](const PagedBitset& t_paged, const RuntimeBitset& t_bitset) {
+    const RuntimeBitset converted = t_paged.toRuntimeBitset();
+    for (std::size_t i = 0; i < t_bitset.blocks(); ++i) {
+      if (converted.getBlock(i) != t_bitset.getBlock(i)) return false;
+    }
+    return t_paged.count() == t_bitset.count();
+  };
+  for (const std::size_t randomSize : {1ul, 64ul, 65ul, PAGE_BITS, PAGE_BITS + 1, size}) {
+    PagedBitset randomPaged(randomSize);
+    RuntimeBitset expected(randomSize);
+    auto randomPair = [&generator, randomSize]() {
+      RuntimeBitset bitset(randomSize);
+      // Some pages empty, some dense
+      for (int i = 0; i < 20; ++i) bitset.set(generator() % randomSize);
+      return std::make_pair(PagedBitset(bitset), bitset);
+    };
+    for (int i = 0; i < 150; ++i) {
+      const std::size_t position = generator() % randomSize;
+      const auto [otherPaged, otherBitset] = randomPair();
+      switch (generator() % 9) {
+        case 0: case 1: randomPaged.set(position); expected.set(position); break;
+        case 2: randomPaged.reset(position); expected.reset(position); break;
+        case 3: randomPaged.flip(position); expected.flip(position); break;
+        case 4: randomPaged &= otherPaged; expected &= otherBitset; break;
+        case 5: randomPaged |= otherPaged; expected |= otherBitset; break;
+        case 6: randomPaged ^= otherPaged; expected ^= otherBitset; break;
+        case 7: randomPaged.flip(); expected.flip(); break;
+        default: randomPaged = otherPaged; expected = otherBitset; break;
+      }
+      assert(sameBits(randomPaged, expected));
+      assert(randomPaged.any() == expected.any() && randomPaged.all() == expected.all());
+      assert(randomPaged.find_first() == expected.find_first());
+      assert(randomPaged.find_next(position) == expected.find_next(position));
+      assert(randomPaged.test(position) == expected.test(position));
+      assert(randomPaged.reclaim() == 0);
+    }
+    const PagedBitset copy = randomPaged;
+    assert(sameBits(copy, expected) && copy.allocatedPages() == randomPaged.allocatedPages());
+    try {
+      randomPaged &= PagedBitset(randomSize + 1);
+      assert(false);
+    } catch (const RunBitsetException::RuntimeBitsetSizeDismatch&) {}
+  }
+}
+
+// The uninitialized constructor only allocates, the bitset is right once all its blocks are written
+void testUninitialized() {
+  for (const std::size_t size : {1ul, 63ul, 64ul, 65ul, 1000ul}) {
+    RuntimeBitset raw(size, uninitialized);
+    assert(raw.size() == size && raw.blocks() == (size + 63) / 64);
+    // setBlock ignores the bits out of the size, so all() doesn´t see them
+    for (std::size_t i = 0; i < raw.blocks(); ++i) raw.setBlock(i, ~static_cast<std::size_t>(0));
+    assert(raw.all() && raw.count() == size && raw.find_first() == 0);
+    raw.reset();
+    assert(raw.none() && raw.find_first() == size);
+    RuntimeBitset written(size, uninitialized);
+    written.set();
+    assert(written.all() && (written ^ raw).count() == size);
+  }
+  // With a number, the blocks after the first one are 0
+  const RuntimeBitset fromNumber(200, ~static_cast<std::size_t>(0));
+  assert(fromNumber.count() == 64 && fromNumber.find_next(64) == 200);
+  try {
+    RuntimeBitset empty(0, uninitialized);
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetInvalidSize&) {}
+}
+
+// With a threshold of 1 byte all the blocks are mapped with mmap
+void testHugePages() {
+  const std::size_t oldThreshold = RuntimeBitset::getHugePageThreshold();
+  RuntimeBitset::setHugePageThreshold(1);
+  {
+    RuntimeBitset mapped(1000);
+#if defined(__linux__)
+    assert(mapped.usesHugePages());
+#endif
+    assert(mapped.none()); // the mapping starts at 0
+    mapped.set(0).set(500).set(999);
+    RuntimeBitset copied = mapped;
+    assert(copied.usesHugePages() == mapped.usesHugePages() && copied.to_string() == mapped.to_string());
+    copied.reset(500);
+    assert(mapped.test(500));
+    RuntimeBitset assigned(1000);
+    assigned = mapped; // same number of blocks, the mapping is reused
+    assert(assigned.to_string() == mapped.to_string());
+    RuntimeBitset moved = std::move(copied);
+    assert(moved.usesHugePages() == mapped.usesHugePages() && moved.count() == 2);
+    RuntimeBitset bigger(5000);
+    bigger = moved; // another number of blocks, the old mapping is released
+    assert(bigger.size() == 1000 && bigger.to_string() == moved.to_string());
+
+    // The mapped blocks are released by the last owner
+    RuntimeBitset shared = mapped;
+    shared.enableCopyOnWrite();
+    {
+      RuntimeBitset first = shared;
+      RuntimeBitset second = shared;
+      assert(first.isShared() && first.usesHugePages() == mapped.usesHugePages());
+      second.set(1); // detaches second, with a new mapping
+      assert(second.count() == 4 && first.count() == 3);
+      shared = RuntimeBitset(10); // first is the last owner now
+      assert(!first.isShared() && first.count() == 3);
+    }
+    RuntimeBitset::setHugePageThreshold(~static_cast<std::size_t>(0));
+    RuntimeBitset normal(1000);
+    assert(!normal.usesHugePages());
+    normal = mapped;
+    assert(!normal.usesHugePages() && normal.to_string() == mapped.to_string());
+  }
+  RuntimeBitset::setHugePageThreshold(oldThreshold);
+}
+
+// With a threshold of 1 byte set(), reset() and the binary operators use streaming stores
+//   odd numbers of blocks end with a normal store, and they give the same as the normal stores
+void testStreamingStores() {
+  const std::size_t oldThreshold = RuntimeBitset::getStreamingThreshold();
+  std::mt19937_64 generator(58);
+  for (const std::size_t size : {1ul, 64ul, 65ul, 130ul, 191ul, 193ul, 320ul, 64ul * 1001 + 7}) {
+    RuntimeBitset first(size), second(size);
+    for (std::size_t i = 0; i < first.blocks(); ++i) {
+      first.setBlock(i, generator());
+      second.setBlock(i, generator());
+    }
+    const std::size_t shift = generator() % size;
+    RuntimeBitset::setStreamingThreshold(~static_cast<std::size_t>(0));
+    const std::vector<std::string> expected = {(first & second).to_string(), (first | second).to_string(), 
+      (first ^ second).to_string(), (first & ~second).to_string(), (first | (second << shift)).to_string()};
+    RuntimeBitset::setStreamingThreshold(1);
+    const std::vector<std::string> streamed = {(first & second).to_string(), (first | second).to_string(), 
+      (first ^ second).to_string(), (first & ~second).to_string(), (first | (second << shift)).to_string()};
+    assert(streamed == expected);
+
+    RuntimeBitset copy = first;
+    assert(copy.to_string() == first.to_string());
+    copy.set();
+    assert(copy.all() && copy.count() == size && !first.all());
+    RuntimeBitset assigned(size);
+    assigned = copy; // same number of blocks
+    assert(assigned.all());
+    assigned.reset();
+    assert(assigned.none() && copy.all() && assigned.find_first() == size);
+    copy.enableCountCache();
+    copy.enableSummary();
+    copy.reset();
+    assert(copy.count() == 0 && copy.none());
+    copy = first ^ first;
+    assert(copy.count() == 0 && copy.find_first() == size);
+  }
+  RuntimeBitset::setStreamingThreshold(oldThreshold);
+}
+
+// The copies share the blocks until one of them is modified
+void testCopyOnWrite() {
+  RuntimeBitset original(200);
+  original.set(3).set(150);
+  original.enableCopyOnWrite();
+  RuntimeBitset copy = original;
+  assert(copy.isCopyOnWrite() && original.isShared() && copy.isShared());
+  copy.set(5); // detaches the copy
+  assert(copy.test(5) && !original.test(5) && !original.isShared() && !copy.isShared());
+
+  RuntimeBitset other = original;
+  other[7] = true;
+  assert(other.test(7) && !original.test(7));
+  RuntimeBitset shifted = original;
+  shifted <<= 1;
+  assert(shifted.test(4) && original.test(3) && !original.test(4));
+  RuntimeBitset flipped = original;
+  flipped.flip();
+  assert(flipped.count() == 198 && original.count() == 2);
+  RuntimeBitset anded = original;
+  anded &= anded; // the same blocks in both sides
+  assert(anded.count() == 2);
+  RuntimeBitset disabled = original;
+  disabled.disableCopyOnWrite(); // it has its own blocks
+  disabled.reset();
+  assert(!disabled.isCopyOnWrite() && original.count() == 2);
+}
+
+// A bitset with the modes of t_mode: 1 count cache, 2 summary, 4 copy on write, 8 dirty tracking with journal
+RuntimeBitset bitsetWithModes(const std::size_t t_size, const std::size_t t_step, const int t_mode) {
+  RuntimeBitset bitset(t_size);
+  for (std::size_t i = t_step / 2; i < t_size; i += t_step) bitset.set(i);
+  if ((t_mode & 1) != 0) bitset.enableCountCache();
+  if ((t_mode & 2) != 0) bitset.enableSummary();
+  if ((t_mode & 4) != 0) bitset.enableCopyOnWrite();
+  if ((t_mode & 8) != 0) bitset.enableDirtyTracking(true);
+  return bitset;
+}
+
+// The copy reuses the blocks of the target if it has the same number of blocks, whatever the modes of each one
+//   if an allocation fails the target is not modified
+void testCopyBetweenModes() {
+  for (const std::size_t sourceSize : {5000ul, 4990ul, 9000ul}) {
+    for (int sourceMode = 0; sourceMode < 16; ++sourceMode) {
+      for (int targetMode = 0; targetMode < 16; ++targetMode) {
+        const RuntimeBitset source = bitsetWithModes(sourceSize, 7, sourceMode);
+        const std::string sourceString = source.to_string();
+        RuntimeBitset target = bitsetWithModes(5000, 300, targetMode);
+        target = source;
+        assert(target.to_string() == sourceString && source.to_string() == sourceString);
+        assert(target.count() == source.count() && target.find_first() == 3 && target.find_next(4) == 10);
+        assert(target.isCountCached() == ((targetMode & 1) != 0) && target.hasSummary() == ((targetMode & 2) != 0));
+        assert(target.isDirtyTracked() == ((targetMode & 8) != 0));
+        target.flip(3); // detaches the target if it shares the blocks
+        assert(!target.test(3) && source.test(3) && target.count() == source.count() - 1);
+
+        // Fail each allocation of the copy, until it works
+        for (long failure = 0; ; ++failure) {
+          RuntimeBitset failing = bitsetWithModes(5000, 300, targetMode);
+          if ((targetMode & 8) != 0) failing.set(1);
+          const std::string before = failing.to_string();
+          const auto dirtyBefore = failing.dirtyRanges();
+          const std::size_t journalBefore = failing.journal().size();
+          const std::size_t countBefore = failing.count();
+          bool thrown = false;
+          allocationsUntilFailure = failure;
+          try {
+            failing = source;
+          } catch (const std::bad_alloc&) {
+            thrown = true;
+          }
+          allocationsUntilFailure = -1;
+          if (!thrown) {
+            assert(failing.to_string() == sourceString && failing.count() == source.count());
+            break;
+          }
+          assert(failing.to_string() == before && failing.count() == countBefore);
+          assert(failing.find_first() == (((targetMode & 8) != 0) ? 1 : 150) && failing.find_next(151) == 450);
+          assert(failing.dirtyRanges() == dirtyBefore && failing.journal().size() == journalBefore);
+        }
+      }
+    }
+  }
+}
+
+// Random modifications of random old versions, every version must keep its own bits
+//   and only the chunks really modified in its history are allocated
+void testPersistentBitset() {
+  std::mt19937_64 generator(61);
+  const std::size_t chunkBits = PersistentBitset::CHUNK_BLOCKS * RuntimeBitset::blockSize();
+  for (const std::size_t size : {1ul, 100ul, 70001ul, 140000ul}) {
+    struct Version {
+      PersistentBitset bitset;
+      RuntimeBitset expected;
+      std::vector<bool> chunks; // modified chunks
+    };
+    std::vector<Version> versions = {{PersistentBitset(size), RuntimeBitset(size),
+      std::vector<bool>((size + chunkBits - 1) / chunkBits, false)}};
+    assert(versions[0].bitset.allocatedChunks() == 0 && versions[0].bitset.none());
+    for (int i = 0; i < 100; ++i) {
+      Version version = versions[generator() % versions.size()];
+      const std::size_t position = generator() % size;
+      const PersistentBitset old = version.bitset;
+      const bool before = version.expected.test(position);
+      switch (generator() % 3) {
+        case 0: version.bitset = old.set(position); version.expected.set(position); break;
+        case 1: version.bitset = old.reset(position); version.expected.reset(position); break;
+        default: version.bitset = old.flip(position); version.expected.flip(position); break;
+      }
+      // Without changes it is the same version, without new chunks
+      assert(version.bitset.sameVersion(old) == (version.expected.test(position) == before));
+      if (!version.bitset.sameVersion(old)) version.chunks[position / chunkBits] = true;
+      versions.push_back(std::move(version));
+    }
+    assert(versions.back().bitset.to_string() == versions.back().expected.to_string());
+    for (const Version& version : versions) {
+      const RuntimeBitset converted = version.bitset.toRuntimeBitset();
+      for (std::size_t block = 0; block < version.expected.blocks(); ++block) {
+        assert(version.bitset.getBlock(block) == version.expected.getBlock(block));
+        assert(converted.getBlock(block) == version.expected.getBlock(block));
+      }
+      assert(version.bitset.count() == version.expected.count());
+      const std::size_t modified = static_cast<std::size_t>(std::count(version.chunks.begin(), version.chunks.end(), true));
+      assert(version.bitset.allocatedChunks() == modified);
+      // Built from a RuntimeBitset only the chunks with bits are allocated
+      std::size_t withBits = 0;
+      for (std::size_t first = 0; first < version.expected.blocks(); first += PersistentBitset::CHUNK_BLOCKS) {
+        bool empty = true;
+        for (std::size_t block = first; block < version.expected.blocks() && block < first + PersistentBitset::CHUNK_BLOCKS; ++block) {
+          if (version.expected.getBlock(block) != 0) empty = false;
+        }
+        if (!empty) ++withBits;
+      }
+      assert(PersistentBitset(version.expected).allocatedChunks() == withBits);
+    }
+  }
+}
+
+// One dirty bit per page of DIRTY_PAGE_BLOCKS blocks, and with the journal each modified block
+void testDirtyTracking() {
+  using Ranges = std::vector<std::pair<std::size_t, std::size_t>>;
+  constexpr std::size_t PAGE_BITS = RuntimeBitset::DIRTY_PAGE_BLOCKS * RuntimeBitset::blockSize();
+  RuntimeBitset bitset(PAGE_BITS * 10);
+  bitset.enableDirtyTracking(true);
+  assert(bitset.dirtyRanges().empty());
+  bitset.set(3);
+  bitset.set(PAGE_BITS * 2 + 1);
+  bitset.reset(PAGE_BITS * 3 + 5); // page 3 is dirty even if the bit was already 0
+  bitset.flip(PAGE_BITS * 9);
+  // The consecutive pages are merged
+  assert((bitset.dirtyRanges() == Ranges{{0, 512}, {1024, 2048}, {4608, 5120}}));
+  assert(bitset.journal().size() == 4);
+  assert(bitset.journal()[1].block == 1024 && bitset.journal()[1].value == 2);
+
+  bitset.clearDirty();
+  bitset.clearJournal();
+  RuntimeBitset other(PAGE_BITS * 10);
+  other.set(PAGE_BITS * 5);
+  bitset |= other; // only the blocks that changed
+  assert((bitset.dirtyRanges() == Ranges{{2560, 3072}}) && bitset.journal().size() == 1);
+  bitset.clearDirty();
+  bitset.clearJournal();
+  bitset |= other;
+  assert(bitset.dirtyRanges().empty() && bitset.journal().empty());
+
+  RuntimeBitset copy = bitset; // the copies don´t track
+  assert(!copy.isDirtyTracked());
+  bitset.disableDirtyTracking();
+  bitset.set(1);
+  assert(bitset.dirtyRanges().empty());
+}
+
+// Applying diff(old, new) to old gives new, for several sizes and changes
+void testDiffPatch() {
+  std::mt19937_64 generator(7);
+  for (const std::size_t size : {1ul, 63ul, 64ul, 65ul, 1000ul, 100003ul}) {
+    RuntimeBitset oldVersion(size);
+    for (int i = 0; i < 50; ++i) oldVersion.set(generator() % size);
+    RuntimeBitset newVersion = oldVersion;
+    for (int i = 0; i < 20; ++i) newVersion.flip(generator() % size);
+    const std::vector<std::uint8_t> delta = diff(oldVersion, newVersion);
+    RuntimeBitset patched = oldVersion;
+    patched.enableCountCache();
+    patched.enableSummary();
+    apply_patch(patched, delta);
+    assert(patched.to_string() == newVersion.to_string() && patched.count() == newVersion.count());
+    assert(diff(oldVersion, oldVersion).size() <= 3); // only the size
+    if (delta.size() > 3) { // a truncated delta is rejected
+      std::vector<std::uint8_t> truncated = delta;
+      truncated.pop_back();
+      RuntimeBitset target = oldVersion;
+      try {
+        apply_patch(target, truncated);
+        assert(false);
+      } catch (const RunBitsetException::RuntimeBitsetInvalidDelta&) {}
+    }
+  }
+  RuntimeBitset small(5);
+  try {
+    apply_patch(small, diff(RuntimeBitset(100), RuntimeBitset(100)));
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetSizeDismatch&) {}
+}
 
+// Binary streams, read and written by chunks of STREAM_CHUNK chars, and the width, fill and adjust of the stream
+void testStreams() {
+  std::mt19937_64 generator(66);
+  for (const std::size_t size : {1ul, 63ul, 64ul, 65ul, 4096ul * 64 + 37}) {
+    RuntimeBitset first(size), second(size + 1);
+    for (std::size_t i = 0; i < first.blocks(); ++i) first.setBlock(i, generator());
+    for (std::size_t i = 0; i < second.blocks(); ++i) second.setBlock(i, generator());
+    std::stringstream stream;
+    stream << first << ' ' << second;
+    assert(stream.str() == first.to_string() + " " + second.to_string());
+    RuntimeBitset firstRead, secondRead; // two bitsets one after another
+    stream >> firstRead >> secondRead;
+    assert(stream && firstRead.size() == size && secondRead.size() == size + 1);
+    assert(firstRead.to_string() == first.to_string() && secondRead.to_string() == second.to_string());
+    assert(firstRead.count() == first.count());
+    // The views are written without being materialized
+    const std::size_t shift = generator() % (size + 1);
+    std::ostringstream views;
+    views << ~first << ' ' << (first << shift) << ' ' << (~first >> shift) << ' ' << hexFormat << ~first;
+    assert(views.str() == (~first).to_string() + " " + (first << shift).to_string() + " " + 
+      (~first >> shift).to_string() + " " + RuntimeBitset(~first).to_hex());
+  }
+
+  const RuntimeBitset bitset(std::string("10110"));
+  std::ostringstream padded;
+  padded << std::setw(8) << std::setfill('*') << bitset << '|' << bitset << '|' 
+    << std::left << std::setw(7) << bitset << '|' << std::setw(2) << bitset;
+  std::ostringstream expected;
+  expected << std::setw(8) << std::setfill('*') << std::string("10110") << '|' << std::string("10110") << '|' 
+    << std::left << std::setw(7) << std::string("10110") << '|' << std::setw(2) << std::string("10110");
+  assert(padded.str() == expected.str() && padded.str() == "***10110|10110|10110**|10110");
+
+  // At most width() digits, and the width is not kept for the next one
+  std::istringstream in("110101 11");
+  RuntimeBitset read;
+  in >> std::setw(3) >> read;
+  assert(read.to_string() == "110" && in.width() == 0);
+  in >> read;
+  assert(read.to_string() == "101");
+  in >> std::setw(10) >> read;
+  assert(read.to_string() == "11" && in.eof() && in.width() == 0);
+  std::istringstream wrong("10x1");
+  try {
+    wrong >> std::setw(5) >> read;
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetUnknownChar&) {}
+  assert(wrong.width() == 0);
+}
+
+// Hex and base64, with strings and streams (with SSSE3 the hex of the whole blocks goes by another path)
+void testTextFormats() {
+  const RuntimeBitset bitset(std::string("0101011111110000"));
+  assert(bitset.to_hex() == "57f0" && bitset.to_base64() == "Ffw");
+  assert(RuntimeBitset::from_hex("57F0").to_string() == bitset.to_string());
+  assert(RuntimeBitset::from_base64("Ffw", 16).to_string() == bitset.to_string());
+  assert(RuntimeBitset::from_hex("57f0", 8).to_string() == "11110000"); // only the less significant
+
+  std::mt19937_64 generator(3);
+  for (const std::size_t size : {1ul, 63ul, 64ul, 65ul, 1000ul, 70001ul}) {
+    RuntimeBitset random(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      if (generator() % 3 == 0) random.set(i);
+    }
+    assert(RuntimeBitset::from_hex(random.to_hex(), size).to_string() == random.to_string());
+    assert(RuntimeBitset::from_base64(random.to_base64(), size).to_string() == random.to_string());
+    std::stringstream stream;
+    stream << hexFormat << random << " " << base64Format << random;
+    RuntimeBitset hex, base64;
+    stream >> hexFormat >> hex >> base64Format >> base64;
+    assert(hex.to_hex() == random.to_hex() && base64.to_base64() == random.to_base64());
+  }
+
+  // An unknown char anywhere, even out of the size, is an error
+  std::string wrongHex(100, 'f');
+  for (const std::size_t position : {0ul, 1ul, 50ul, 99ul}) {
+    for (const char wrong : {'g', 'G', '/', ':', '@', ' ', '\xff'}) {
+      std::string text = wrongHex;
+      text[position] = wrong;
+      try {
+        RuntimeBitset::from_hex(text, 64);
+        assert(false);
+      } catch (const RunBitsetException::RuntimeBitsetUnknownChar&) {}
+    }
+  }
+  try {
+    RuntimeBitset::from_base64("AB-C");
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetUnknownChar&) {}
+  RuntimeBitset target(std::string("101"));
+  std::stringstream wrongStream("ffzf");
+  try {
+    wrongStream >> hexFormat >> target;
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetUnknownChar&) {}
+  assert(target.to_string() == "101"); // not modified
+  std::stringstream empty("   ");
+  empty >> hexFormat >> target;
+  assert(empty.fail() && target.to_string() == "101");
+}
+
+// The operations on the compressed runs give the same as the uncompressed bitsets
+void testEwahBitset() {
+  std::mt19937_64 generator(3);
+  // Regions of 700 bits all 0, all 1 and random, so there are runs and literal words
+  auto randomBitset = [&generator](const std::size_t t_size, const bool t_runs) {
+    RuntimeBitset bitset(t_size);
+    for (std::size_t i = 0; i < t_size; ++i) {
+      const std::size_t region = (i / 700) % 4;
+      const bool value = t_runs 
+        ? (region == 1 || (region > 1 && generator() % 2 == 0)) 
+        : (generator() % 50 == 0);
+      if (value) bitset.set(i);
+    }
+    return bitset;
+  };
+  for (const std::size_t size : {1ul, 64ul, 65ul, 1000ul, 100001ul}) {
+    for (const bool runs : {false, true}) {
+      const RuntimeBitset first = randomBitset(size, runs);
+      const RuntimeBitset second = randomBitset(size, !runs);
+      const EwahBitset compressedFirst(first), compressedSecond(second);
+      assert(compressedFirst.toRuntimeBitset().to_string() == first.to_string());
+      assert(compressedFirst.count() == first.count());
+      assert((compressedFirst & compressedSecond).to_string() == (first & second).to_string());
+      assert((compressedFirst | compressedSecond).to_string() == (first | second).to_string());
+      assert((compressedFirst ^ compressedSecond).to_string() == (first ^ second).to_string());
+      assert(andNot(compressedFirst, compressedSecond).to_string() == (first & ~second).to_string());
+      assert((compressedFirst & compressedSecond).count() == (first & second).count());
+      for (int i = 0; i < 50; ++i) {
+        const std::size_t position = generator() % size;
+        assert(compressedFirst.test(position) == first.test(position));
+      }
+    }
+  }
+  RuntimeBitset full(1 << 24);
+  full.set();
+  const EwahBitset compressedFull(full), compressedEmpty(1 << 24);
+  assert(compressedFull.all() && compressedFull.compressedWords() <= 2); // one run
+  assert((compressedFull & compressedEmpty).none() && (compressedFull | compressedEmpty).count() == (1u << 24));
+}
+
+// allocate_range() gives the lowest run of free ids, like a search id by id
+void testIdAllocatorRange() {
+  std::mt19937_64 generator(5);
+  for (const std::size_t size : {1ul, 64ul, 65ul, 4097ul, 20000ul}) {
+    IdAllocator allocator(size);
+    std::vector<bool> used(size, false);
+    std::size_t allocated = 0;
+    auto lowestRun = [&used, size](const std::size_t t_count) {
+      std::size_t length = 0;
+      for (std::size_t id = 0; id < size; ++id) {
+        length = used[id] ? 0 : length + 1;
+        if (length == t_count) return id + 1 - t_count;
+      }
+      return size;
+    };
+    for (int i = 0; i < 2000; ++i) {
+      const std::size_t operation = generator() % 3;
+      if (operation == 0) { // free one, or a range of them
+        const std::size_t first = generator() % size;
+        std::size_t count = 0;
+        while (first + count < size && used[first + count] && count < 10) ++count;
+        if (count == 0) continue;
+        allocator.free_range(first, count);
+        std::fill(used.begin() + static_cast<long>(first), used.begin() + static_cast<long>(first + count), false);
+        allocated -= count;
+      }
+      else { // runs that go through several blocks too
+        const std::size_t count = 1 + generator() % ((operation == 1) ? 8 : 150);
+        const std::size_t first = allocator.allocate_range(count);
+        assert(first == lowestRun(count));
+        if (first == size) continue;
+        for (std::size_t id = first; id < first + count; ++id) {
+          assert(allocator.isAllocated(id));
+          used[id] = true;
+        }
+        allocated += count;
+      }
+      assert(allocator.allocated() == allocated);
+    }
+  }
+  IdAllocator allocator(100);
+  assert(allocator.allocate_range(101) == 100 && allocator.allocate_range(100) == 0);
+  try {
+    allocator.free_range(90, 20); // out of the size
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetOutOfRange&) {}
+  allocator.free_range(10, 5);
+  try {
+    allocator.free_range(8, 4); // 10 and 11 are not allocated
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetInvalidId&) {}
+  assert(allocator.allocate_range(6) == 100 && allocator.allocate_range(5) == 10);
+}
+
+// Path of a file in the temporary directory
+std::string temporaryPath(const std::string& t_name) {
+  return (std::filesystem::temp_directory_path() / t_name).string();
+}
+
+// Threads allocating and freeing at the same time, around the moment it gets full
+//   every id is given to only one thread, and at the end all the free ids can be allocated
+void testConcurrentIdAllocator() {
+  for (const std::size_t size : {64ul, 4097ul, 64ul * 64 * 3 + 5}) {
+    ConcurrentIdAllocator allocator(size);
+    const std::size_t numberOfThreads = 8;
+    std::vector<std::atomic<bool>> owned(size);
+    std::atomic<bool> repeated{false};
+    std::vector<std::vector<std::size_t>> held(numberOfThreads);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < numberOfThreads; ++t) {
+      threads.emplace_back([&, t]() {
+        std::mt19937_64 generator(t);
+        std::vector<std::size_t>& mine = held[t];
+        // Together they want a bit more than the size, so it gets full and not full again many times
+        const std::size_t limit = size / numberOfThreads + 2;
+        for (int i = 0; i < 20000; ++i) {
+          if (mine.size() < limit && generator() % 3 != 0) {
+            const std::size_t id = allocator.allocate();
+            if (id == size) continue; // full
+            if (id > size || owned[id].exchange(true)) repeated = true;
+            mine.push_back(id);
+          }
+          else if (!mine.empty()) {
+            const std::size_t index = generator() % mine.size();
+            const std::size_t id = mine[index];
+            mine[index] = mine.back();
+            mine.pop_back();
+            owned[id] = false;
+            allocator.free(id);
+          }
+        }
+      });
+    }
+    for (std::thread& thread : threads) thread.join();
+    assert(!repeated);
+    std::size_t total = 0;
+    for (const std::vector<std::size_t>& mine : held) {
+      total += mine.size();
+      for (const std::size_t id : mine) assert(allocator.isAllocated(id));
+    }
+    assert(allocator.allocated() == total);
+    // The rest of the ids, each one only once
+    for (std::size_t id = allocator.allocate(); id != size; id = allocator.allocate()) {
+      assert(!owned[id].exchange(true));
+      ++total;
+    }
+    assert(total == size && allocator.allocated() == size);
+    for (std::size_t id = 0; id < size; ++id) assert(owned[id] && allocator.isAllocated(id));
+    allocator.free(size / 2);
+    assert(allocator.allocate() == size / 2 && allocator.allocate() == size);
+  }
+}
+
+// A file modified after save() is rejected by load() and by the Loader (at the end)
+void testBitsetFileChecksum() {
+  const std::string path = temporaryPath("runtimebitset_test.bits");
+  RuntimeBitset bitset(100000);
+  for (std::size_t i = 0; i < bitset.size(); i += 7) bitset.set(i);
+  BitsetFile::save(bitset, path);
+  assert(BitsetFile::load(path).to_string() == bitset.to_string());
+  { // one byte of the block 10
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>((BitsetFile::HEADER_WORDS + 10) * sizeof(std::uint64_t)));
+    file.put('\x5a');
+  }
+  try {
+    BitsetFile::load(path);
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetInvalidFile&) {}
+  BitsetFile::Loader loader(path);
+  assert(loader.size() == bitset.size()); // the header is right
+  try {
+    loader.get();
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetInvalidFile&) {}
+  std::filesystem::remove(path);
+}
+
+// completion() outlives the Loader, stopped before the end it has RuntimeBitsetLoadCancelled
+void testLoaderCancelled() {
+  const std::string path = temporaryPath("runtimebitset_test_cancelled.bits");
+  RuntimeBitset bitset((BitsetFile::CHUNK_BLOCKS * 2 + 1) * RuntimeBitset::blockSize()); // three chunks
+  bitset.set(0).set(bitset.size() - 1);
+  BitsetFile::save(bitset, path);
+  std::shared_future<void> completion;
+  {
+    BitsetFile::Loader loader(path);
+    completion = loader.completion();
+  } // stopped, almost always after the first chunk
+  assert(completion.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+  try {
+    completion.get(); // or it finished before the stop
+  } catch (const RunBitsetException::RuntimeBitsetLoadCancelled&) {}
+  {
+    BitsetFile::Loader loader(path);
+    completion = loader.completion();
+    assert(loader.get().count() == 2);
+  }
+  completion.get(); // a finished loading is not cancelled
+  std::filesystem::remove(path);
+}
+
+// The chunks of 5 blocks don´t divide the 38 blocks, the last chunk is shorter
+void testBitsetCombiner() {
+  std::mt19937_64 generator(70);
+  const std::size_t size = 37 * 64 + 5;
+  std::vector<RuntimeBitset> bitsets;
+  std::vector<std::string> paths;
+  for (int i = 0; i < 3; ++i) {
+    RuntimeBitset bitset(size);
+    for (std::size_t j = 0; j < bitset.blocks(); ++j) bitset.setBlock(j, generator());
+    paths.push_back(temporaryPath("runtimebitset_test_combiner" + std::to_string(i) + ".bits"));
+    BitsetFile::save(bitset, paths.back());
+    bitsets.push_back(std::move(bitset));
+  }
+  const std::string output = temporaryPath("runtimebitset_test_combined.bits");
+  BitsetCombiner combiner(paths, 5);
+  assert(combiner.size() == size && combiner.inputs() == 3);
+  const std::vector<std::pair<BitsetCombiner::Operation, RuntimeBitset>> expected = {
+    {BitsetCombiner::AND, bitsets[0] & bitsets[1] & bitsets[2]},
+    {BitsetCombiner::OR, bitsets[0] | bitsets[1] | bitsets[2]},
+    {BitsetCombiner::XOR, bitsets[0] ^ bitsets[1] ^ bitsets[2]},
+    {BitsetCombiner::AND_NOT, bitsets[0] & ~bitsets[1] & ~bitsets[2]}};
+  for (const auto& [operation, result] : expected) {
+    assert(combiner.count(operation) == result.count());
+    combiner.combineTo(output, operation);
+    assert(BitsetFile::load(output).to_string() == result.to_string());
+  }
+  // An expression, the no significant bits are cleaned after it
+  combiner.combineTo(output, [](const std::vector<const std::size_t*>&, std::size_t* t_result, std::size_t t_count) {
+    std::fill_n(t_result, t_count, ~static_cast<std::size_t>(0));
+  });
+  assert(BitsetFile::load(output).all());
+
+  // One input can´t be the output, it would be emptied before being read
+  try {
+    combiner.combineTo(paths[1], BitsetCombiner::OR);
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetFileError&) {}
+  assert(BitsetFile::load(paths[1]).to_string() == bitsets[1].to_string());
+
+  // A wrong input is only found at the end, the old output is kept
+  {
+    std::fstream file(paths[2], std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>((BitsetFile::HEADER_WORDS + 36) * sizeof(std::uint64_t)));
+    file.put('\x5a');
+  }
+  BitsetCombiner corrupted(paths, 5);
+  try {
+    corrupted.combineTo(output, BitsetCombiner::AND);
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetInvalidFile&) {}
+  assert(BitsetFile::load(output).all() && !std::filesystem::exists(output + ".tmp"));
+  for (const std::string& path : paths) std::filesystem::remove(path);
+  std::filesystem::remove(output);
+}
+
+// Only cacheCapacity() pages in memory, the modified pages are written back when they are evicted
+void testDiskBitset() {
+  const std::string path = temporaryPath("runtimebitset_test_disk.bits");
+  constexpr std::size_t PAGE_BITS = DiskBitset::PAGE_BLOCKS * RuntimeBitset::blockSize();
+  const std::size_t size = PAGE_BITS * 20 + 37; // 21 pages, the last one shorter
+  DiskBitset::create(path, size);
+  RuntimeBitset expected(size);
+  {
+    // 4 pages of budget: 2 for the read ahead, 2 for the cache
+    DiskBitset disk(path, 4 * DiskBitset::PAGE_BLOCKS * sizeof(std::size_t));
+    assert(disk.cacheCapacity() == 2 && disk.none());
+    disk.set(5).set(PAGE_BITS * 20 + 36);
+    expected.set(5).set(PAGE_BITS * 20 + 36);
+    // The page 0 is evicted (dirty) and read again
+    for (std::size_t page = 1; page < 20; page += 3) {
+      disk.flip(page * PAGE_BITS + page);
+      expected.flip(page * PAGE_BITS + page);
+      assert(disk.cachedPages() <= disk.cacheCapacity());
+    }
+    assert(disk.test(5) && disk.test(PAGE_BITS * 20 + 36));
+    std::mt19937_64 generator(11);
+    for (int i = 0; i < 5000; ++i) {
+      const std::size_t position = generator() % size;
+      disk.flip(position);
+      expected.flip(position);
+      assert(disk.cachedPages() <= disk.cacheCapacity());
+    }
+    assert(disk.count() == expected.count());
+    assert(disk.toRuntimeBitset().to_string() == expected.to_string());
+    disk.flush(); // the file can be loaded, with the right checksum
+    assert(BitsetFile::load(path).to_string() == expected.to_string());
+    disk.flip(0);
+    expected.flip(0);
+  } // the destructor flushes
+  assert(BitsetFile::load(path).to_string() == expected.to_string());
+  std::filesystem::remove(path);
+}
+
+// parseFormat and formatTo without std::format, formatTo is compared with the digits read bit by bit
+void testFormatTo() {
+  auto parse = [](const std::string& t_spec, RuntimeBitset::FormatSpec& t_result) {
+    std::string::const_iterator position = t_spec.begin();
+    const bool valid = RuntimeBitset::parseFormat(position, t_spec.end(), t_result);
+    return valid && position == t_spec.end();
+  };
+  RuntimeBitset::FormatSpec spec;
+  assert(parse("h12_4X", spec) && spec.leading == 12 && spec.trailing == 0);
+  assert(spec.separator == '_' && spec.group == 4 && spec.type == 'X');
+  spec = {};
+  assert(parse("t7", spec) && spec.trailing == 7 && spec.separator == 0 && spec.type == 'b');
+  spec = {};
+  assert(parse("", spec) && spec.leading == 0 && spec.type == 'b');
+  for (const std::string wrong : {"t0", "h", "_", "_0x", ":x", "<8", ">8"}) {
+    spec = {};
+    assert(!parse(wrong, spec));
+  }
+  spec = {};
+  assert(!parse("x5", spec)); // the 5 is not part of the spec
+
+  std::mt19937_64 generator(67);
+  for (const std::size_t size : {1ul, 3ul, 4ul, 63ul, 64ul, 65ul, 127ul, 200ul, 1001ul}) {
+    RuntimeBitset bitset(size);
+    for (std::size_t i = 0; i < bitset.blocks(); ++i) bitset.setBlock(i, generator());
+    for (int i = 0; i < 40; ++i) {
+      spec = {};
+      if (generator() % 3 == 0) spec.leading = 1 + generator() % (size + 5);
+      else if (generator() % 2 == 0) spec.trailing = 1 + generator() % (size + 5);
+      if (generator() % 2 == 0) {
+        spec.separator = '_';
+        spec.group = 1 + generator() % 9;
+      }
+      spec.type = "bxX"[generator() % 3];
+      // Digit by digit, from the less significant
+      const std::size_t first = (spec.leading != 0 && spec.leading < size) ? size - spec.leading : 0;
+      const std::size_t last = (spec.trailing != 0 && spec.trailing < size) ? spec.trailing : size;
+      const std::size_t bits = (spec.type == 'b') ? 1 : 4;
+      std::string expected;
+      for (std::size_t digit = 0; first + digit * bits < last; ++digit) {
+        if (spec.group != 0 && digit != 0 && digit % spec.group == 0) expected += spec.separator;
+        std::size_t value = 0;
+        for (std::size_t b = 0; b < bits && first + digit * bits + b < last; ++b) {
+          if (bitset.test(first + digit * bits + b)) value |= static_cast<std::size_t>(1) << b;
+        }
+        expected += (spec.type == 'X') ? "0123456789ABCDEF"[value] : "0123456789abcdef"[value];
+      }
+      std::reverse(expected.begin(), expected.end());
+      std::string result = "[";
+      bitset.formatTo(std::back_inserter(result), spec);
+      assert(result == "[" + expected);
+    }
+  }
+}
+
+// Writes a segment by hand with the header words t_header and t_length bytes
+void writeSegment(const std::string& t_name, const std::vector<std::uint64_t>& t_header, const std::size_t t_length) {
+  const int file = ::shm_open(t_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  assert(file >= 0 && ::ftruncate(file, static_cast<off_t>(t_length)) == 0);
+  void* memory = ::mmap(nullptr, t_length, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  ::close(file);
+  assert(memory != MAP_FAILED);
+  std::copy(t_header.begin(), t_header.end(), static_cast<std::uint64_t*>(memory));
+  ::munmap(memory, t_length);
+}
+
+// Two mappings of the same segment in this process, and another one in a child process
+void testSharedRuntimeBitset() {
+  const std::string name = "/runtimebitset_test_" + std::to_string(::getpid());
+  SharedRuntimeBitset::remove(name); // from a test that failed before
+  {
+    SharedRuntimeBitset created = SharedRuntimeBitset::create(name, 1000);
+    assert(created.size() == 1000 && created.blocks() == 16 && created.none());
+    SharedRuntimeBitset attached = SharedRuntimeBitset::attach(name.substr(1)); // without "/"
+    assert(attached.size() == 1000 && attached.name() == name);
+    assert(!created.testAndSet(5) && attached.testAndSet(5)); // only the first one gets false
+    assert(attached.test(5) && !attached.testAndReset(7) && created.testAndReset(5) && !attached.test(5));
+    created.set(999).flip(0);
+    assert(attached.count() == 2 && attached.find_first() == 0 && attached.find_next(1) == 999);
+    RuntimeBitset other(1000);
+    other.set(10).set(999);
+    attached ^= other;
+    assert(created.count() == 2 && created.test(0) && created.test(10));
+    assert(created.toRuntimeBitset().to_string() == attached.to_string());
+    created.set();
+    assert(attached.all() && attached.getBlock(15) == (static_cast<std::size_t>(1) << (1000 - 960)) - 1);
+
+    try {
+      SharedRuntimeBitset::create(name, 1000);
+      assert(false);
+    } catch (const RunBitsetException::RuntimeBitsetSharedMemoryError&) {}
+    SharedRuntimeBitset opened = SharedRuntimeBitset::openOrCreate(name, 1000);
+    assert(opened.all());
+    try {
+      SharedRuntimeBitset::openOrCreate(name, 1001);
+      assert(false);
+    } catch (const RunBitsetException::RuntimeBitsetSizeDismatch&) {}
+
+    // The mappings still work after remove(), but nobody else can attach
+    assert(SharedRuntimeBitset::remove(name) && !SharedRuntimeBitset::remove(name));
+    attached.reset(3);
+    assert(!created.test(3));
+    try {
+      SharedRuntimeBitset::attach(name);
+      assert(false);
+    } catch (const RunBitsetException::RuntimeBitsetSharedMemoryError&) {}
+    SharedRuntimeBitset recreated = SharedRuntimeBitset::openOrCreate(name, 1001); // a new segment
+    assert(recreated.size() == 1001 && recreated.none() && !created.all() && created.count() == 999);
+    SharedRuntimeBitset::remove(name);
+  }
+
+  // Headers that are not right
+  const std::uint64_t magic = 0x4d4853544942554e;
+  const std::size_t length = 64 + 16 * sizeof(std::size_t);
+  for (const std::vector<std::uint64_t>& header : std::vector<std::vector<std::uint64_t>>{
+    {magic + 1, 1, 1000, 16}, // magic
+    {magic, 2, 1000, 16}, // version
+    {magic, 1, 0, 0}, // size
+    {magic, 1, 1000, 15}, // blocks
+    {magic, 1, 2000, 32}}) { // longer than the segment
+    writeSegment(name, header, length);
+    try {
+      SharedRuntimeBitset::attach(name);
+      assert(false);
+    } catch (const RunBitsetException::RuntimeBitsetInvalidSegment&) {}
+    SharedRuntimeBitset::remove(name);
+  }
+  // A creator that died before writing the header, it is found after the timeout until it is removed
+  writeSegment(name, {}, length);
+  try {
+    SharedRuntimeBitset::openOrCreate(name, 1000);
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetStaleSegment&) {}
+  assert(SharedRuntimeBitset::remove(name));
+  assert(SharedRuntimeBitset::openOrCreate(name, 1000).none());
+  SharedRuntimeBitset::remove(name);
+
+  // Parent and child take the same bits with testAndSet, each bit is won only once
+  //   the child marks the bits it won in the second half
+  const std::size_t bits = 20000;
+  RuntimeBitset parentWon(bits);
+  {
+    SharedRuntimeBitset marks = SharedRuntimeBitset::create(name, 2 * bits);
+    const pid_t child = ::fork();
+    assert(child >= 0);
+    if (child == 0) {
+      SharedRuntimeBitset inChild = SharedRuntimeBitset::attach(name);
+      for (std::size_t i = 0; i < bits; ++i) {
+        if (!inChild.testAndSet(i)) inChild.set(bits + i);
+      }
+      ::_exit(0);
+    }
+    for (std::size_t i = bits; i > 0; --i) { // from the other side, so they meet in the middle
+      if (!marks.testAndSet(i - 1)) parentWon.set(i - 1);
+    }
+    int status = 0;
+    assert(::waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    for (std::size_t i = 0; i < bits; ++i) {
+      assert(marks.test(i) && parentWon.test(i) != marks.test(bits + i));
+    }
+    SharedRuntimeBitset::remove(name);
+  }
+}
+
+// finalize() against the OR of the same positions in one RuntimeBitset, with sparse, dense and empty shards
+void testShardedBitsetAccumulator() {
+  auto sameBlocks = [](const RuntimeBitset& t_1, const RuntimeBitset& t_2) {
+    if (t_1.size() != t_2.size() || t_1.count() != t_2.count()) return false;
+    for (std::size_t i = 0; i < t_1.blocks(); ++i) {
+      if (t_1.getBlock(i) != t_2.getBlock(i)) return false;
+    }
+    return true;
+  };
+  std::mt19937_64 generator(72);
+  // More than MERGE_BLOCKS blocks, and not a multiple of 64
+  for (const std::size_t size : {1ul, 100ul, 64ul * 9000 + 17}) {
+    const std::size_t blocks = (size + 63) / 64;
+    ShardedBitsetAccumulator accumulator(size, 4);
+    RuntimeBitset expected(size);
+    assert(accumulator.shards() == 4 && sameBlocks(accumulator.finalize(3), expected));
+    // Shard 0 sparse, 1 dense, 2 sparse until the second round, 3 empty
+    for (int round = 0; round < 2; ++round) {
+      const std::vector<std::size_t> positions = {(round == 0) ? blocks / 8 : 0, blocks / 3 + 1, 
+        (round == 0) ? blocks / 8 : blocks / 2 + 1, 0};
+      std::vector<std::vector<std::size_t>> sets(4);
+      for (std::size_t shard = 0; shard < 4; ++shard) {
+        for (std::size_t i = 0; i < positions[shard]; ++i) sets[shard].push_back(generator() % size);
+        if (shard == 0 && round == 1) sets[shard].push_back(size - 1);
+      }
+      std::vector<std::thread> threads;
+      for (std::size_t shard = 0; shard < 4; ++shard) {
+        threads.emplace_back([&accumulator, &sets, shard]() {
+          for (const std::size_t position : sets[shard]) accumulator.shard(shard).set(position);
+        });
+      }
+      for (std::thread& thread : threads) thread.join();
+      for (const std::vector<std::size_t>& positions : sets) {
+        for (const std::size_t position : positions) expected.set(position);
+      }
+      // With less than 4 blocks any position makes the shard dense
+      assert(!accumulator.shard(3).isDense() && accumulator.shard(3).bufferedPositions() == 0);
+      assert(blocks < 4 || (!accumulator.shard(0).isDense() && accumulator.shard(1).isDense()));
+      assert(blocks < 4 || accumulator.shard(2).isDense() == (round == 1));
+      for (const std::size_t threads : {1ul, 3ul, 8ul}) {
+        assert(sameBlocks(accumulator.finalize(threads), expected)); // and again, with the buffers sorted
+      }
+      RuntimeBitset summarized = accumulator.finalize(2);
+      assert(summarized.find_first() == expected.find_first() && summarized.none() == expected.none());
+    }
+    accumulator.clear();
+    assert(accumulator.finalize().none());
+  }
+}
+
+// The batch members and the copies of BitsetPool against the same operations in each RuntimeBitset
+void testBitsetPool() {
+  std::mt19937_64 generator(74);
+  const std::size_t width = 130; // the last block is not full
+  auto randomBitset = [&generator]() {
+    RuntimeBitset bitset(width);
+    for (std::size_t i = 0; i < bitset.blocks(); ++i) bitset.setBlock(i, generator());
+    return bitset;
+  };
+  auto samePool = [](const BitsetPool& t_pool, const std::vector<RuntimeBitset>& t_bitsets) {
+    if (t_pool.size() != t_bitsets.size()) return false;
+    for (std::size_t i = 0; i < t_pool.size(); ++i) {
+      if (t_pool[i].to_string() != t_bitsets[i].to_string()) return false;
+    }
+    return true;
+  };
+  BitsetPool pool(width);
+  std::vector<RuntimeBitset> expected;
+  for (int i = 0; i < 21; ++i) {
+    expected.push_back(randomBitset());
+    assert(pool.push_back(expected.back()) == expected.size() - 1);
+  }
+  assert(pool.blocks() == 3 && samePool(pool, expected));
+  for (int i = 0; i < 6; ++i) {
+    const RuntimeBitset other = randomBitset();
+    switch (i % 3) {
+      case 0: pool.and_with_all(other); for (RuntimeBitset& bitset : expected) bitset &= other; break;
+      case 1: pool.or_with_all(other); for (RuntimeBitset& bitset : expected) bitset |= other; break;
+      default: pool.xor_with_all(other); for (RuntimeBitset& bitset : expected) bitset ^= other; break;
+    }
+    const std::vector<std::size_t> counts = pool.count_all();
+    assert(samePool(pool, expected) && counts.size() == expected.size());
+    for (std::size_t j = 0; j < counts.size(); ++j) assert(counts[j] == expected[j].count());
+  }
+  try {
+    pool.or_with_all(RuntimeBitset(width + 1));
+    assert(false);
+  } catch (const RunBitsetException::RuntimeBitsetSizeDismatch&) {}
+
+  // A view of the pool itself, when the push_back has to grow the pool
+  pool.reserve(pool.size());
+  while (pool.size() < pool.capacity()) {
+    pool.push_back(pool[0]);
+    expected.push_back(expected[0]);
+  }
+  pool.push_back(pool[pool.size() - 1]);
+  expected.push_back(expected.back());
+  assert(pool.size() <= pool.capacity() && samePool(pool, expected));
+
+  // The copies have their own blocks
+  BitsetPool copied(pool);
+  copied[0].flip();
+  assert(samePool(pool, expected) && copied[0].to_string() == (~expected[0]).to_string());
+  BitsetPool assigned(7, 3);
+  assigned = pool;
+  assert(assigned.width() == width && samePool(assigned, expected));
+  assigned.xor_with_all(expected[1]);
+  assert(samePool(pool, expected) && assigned[1].none());
+  BitsetPool empty(width);
+  BitsetPool emptyCopy(empty);
+  assert(emptyCopy.empty() && emptyCopy.data() == nullptr);
+  emptyCopy.push_back(expected[2]);
+  assert(emptyCopy[0].to_string() == expected[2].to_string());
+
+  BitsetPool moved(std::move(copied));
+  assert(copied.empty() && moved.size() == expected.size() && moved[1].to_string() == expected[1].to_string());
+  copied.push_back(expected[3]); // a moved pool can be used again
+  assert(copied.size() == 1 && copied[0].to_string() == expected[3].to_string());
+  assigned = std::move(moved);
+  assert(moved.empty() && assigned[0].to_string() == (~expected[0]).to_string());
+  assigned = assigned;
+  assert(assigned.size() == expected.size());
+}
+
+// knn() and radius_search() with and without multi index give the same as a distance bit by bit
+void testHammingIndex() {
+  using Neighbour = HammingIndex::Neighbour;
+  std::mt19937_64 generator(4);
+  // All the bitsets sorted by distance, with the same distance the lowest index first, like the index
+  // knn() is the first k of them, radius_search() the ones up to the radius
+  auto bruteForce = [](const BitsetPool& t_pool, const RuntimeBitset& t_query) {
+    std::vector<Neighbour> toReturn;
+    for (std::size_t i = 0; i < t_pool.size(); ++i) {
+      std::size_t distance = 0;
+      for (std::size_t bit = 0; bit < t_query.size(); ++bit) distance += t_pool[i].test(bit) != t_query.test(bit);
+      toReturn.push_back({i, distance});
+    }
+    std::stable_sort(toReturn.begin(), toReturn.end(), 
+      [](const Neighbour& t_1, const Neighbour& t_2) {return t_1.distance < t_2.distance;});
+    return toReturn;
+  };
+  auto nearest = [](const std::vector<Neighbour>& t_all, const std::size_t t_k) {
+    return std::vector<Neighbour>(t_all.begin(), t_all.begin() + std::min(t_k, t_all.size()));
+  };
+  auto inRadius = [](const std::vector<Neighbour>& t_all, const std::size_t t_radius) {
+    return std::vector<Neighbour>(t_all.begin(), std::find_if(t_all.begin(), t_all.end(), 
+      [t_radius](const Neighbour& t_neighbour) {return t_neighbour.distance > t_radius;}));
+  };
+  auto same = [](const std::vector<Neighbour>& t_1, const std::vector<Neighbour>& t_2) {
+    return std::equal(t_1.begin(), t_1.end(), t_2.begin(), t_2.end(), 
+      [](const Neighbour& t_a, const Neighbour& t_b) {return t_a.index == t_b.index && t_a.distance == t_b.distance;});
+  };
+  for (const std::size_t width : {37ul, 64ul, 100ul, 512ul}) {
+    // Groups of near bitsets, so the small radius find something
+    std::vector<RuntimeBitset> centers;
+    for (int i = 0; i < 10; ++i) {
+      RuntimeBitset center(width);
+      for (std::size_t bit = 0; bit < width; ++bit) if (generator() % 2 == 0) center.set(bit);
+      centers.push_back(center);
+    }
+    auto nearBitset = [&](const std::size_t t_flips) {
+      RuntimeBitset bitset = centers[generator() % centers.size()];
+      for (std::size_t i = 0; i < t_flips; ++i) bitset.flip(generator() % width);
+      return bitset;
+    };
+    BitsetPool pool(width);
+    for (int i = 0; i < 2000; ++i) pool.push_back(nearBitset(generator() % 6));
+    for (const std::size_t threads : {1ul, 3ul}) {
+      HammingIndex index(pool, threads);
+      for (const std::size_t substrings : {0ul, 1ul, 4ul, 8ul}) {
+        index.buildMultiIndex(substrings);
+        for (int i = 0; i < 5; ++i) {
+          const RuntimeBitset query = nearBitset(generator() % 4);
+          const std::vector<Neighbour> all = bruteForce(pool, query);
+          for (const std::size_t k : {1ul, 10ul, 3000ul}) assert(same(index.knn(query, k), nearest(all, k)));
+          for (const std::size_t radius : {0ul, 3ul, 20ul}) {
+            assert(same(index.radius_search(query, radius), inRadius(all, radius)));
+          }
+        }
+      }
+      // The bitsets added after buildMultiIndex() are found too
+      index.buildMultiIndex(4);
+      for (int i = 0; i < 20; ++i) pool.push_back(centers[i % centers.size()]);
+      const std::vector<Neighbour> all = bruteForce(pool, centers[0]);
+      assert(same(index.knn(centers[0], 30), nearest(all, 30)));
+      assert(same(index.radius_search(centers[0], 2), inRadius(all, 2)));
+      pool.resize(2000);
+    }
+    try {
+      static_cast<void>(HammingIndex(pool).knn(RuntimeBitset(width + 1), 1));
+      assert(false);
+    } catch (const RunBitsetException::RuntimeBitsetSizeDismatch&) {}
+  }
+}
+
+#if defined(__cpp_lib_format)
+// std::format with the spec of RuntimeBitset::FormatSpec
+void testFormat() {
+  const RuntimeBitset bitset(std::string("0101011111110000"));
+  assert(std::format("{}", bitset) == "0101011111110000");
+  assert(std::format("{:b}", bitset) == "0101011111110000");
+  assert(std::format("{:x}", bitset) == "57f0");
+  assert(std::format("{:X}", bitset) == "57F0");
+  assert(std::format("{:t12_4}", bitset) == "0111_1111_0000");
+  assert(std::format("{:h8x}", bitset) == "57");
+  assert(std::format("[{: 2x}]", bitset) == "[57 f0]");
+  // The spec of a string known at compile time is checked by the compiler, the rest throw
+  for (const char* wrong : {"{:q}", "{:t0}", "{:h}", "{:>8}", "{:<8x}", "{:_}", "{:_0x}", "{:x5}"}) {
+    try {
+      static_cast<void>(std::vformat(wrong, std::make_format_args(bitset)));
+      assert(false);
+    } catch (const std::format_error&) {}
+  }
+}
+#endif
+
+} // namespace
+
+int main() {
+  testReference();
+  testComplementView();
+  testShiftView();
+  testCountCache();
+  testSummary();
+  testPagedBitset();
+  testUninitialized();
+  testHugePages();
+  testStreamingStores();
+  testCopyOnWrite();
+  testDirtyTracking();
+  testCopyBetweenModes();
+  testPersistentBitset();
+  testDiffPatch();
+  testTextFormats();
+  testStreams();
+  testEwahBitset();
+  testIdAllocatorRange();
+  testConcurrentIdAllocator();
+  testBitsetFileChecksum();
+  testLoaderCancelled();
+  testBitsetCombiner();
+  testSharedRuntimeBitset();
+  testShardedBitsetAccumulator();
+  testBitsetPool();
+  testDiskBitset();
+  testHammingIndex();
+  testFormatTo();
+#if defined(__cpp_lib_format)
+  testFormat();
+#endif
+  std::cout << "All tests passed" << std::endl;
   return 0;
-}
\ No newline at end of file
+}